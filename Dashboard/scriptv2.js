@@ -52,93 +52,77 @@ function formatFullTime(ts) {
   });
 }
 
-function updateSensor(sensor) {
-  fetch(`${base}/sensor/${sensor.id}`)
-    .then(res => res.json())
-    .then(data => {
-      const info = document.getElementById(`info-${sensor.id}`);
-      const alertIcon = document.getElementById(`alert-${sensor.id}`);
-      const updated = document.getElementById(`last-${sensor.id}`);
-
-      if (data.error) {
-        info.innerHTML = "<span class='offline'>No data available</span>";
-        alertIcon.className = "alert-icon bad";
-        return;
-      }
-
-      const temp = parseFloat(data.temp);
-      const humidity = parseFloat(data.humidity);
-      const tds = parseFloat(data.tds || data.TDS || 0);
-      const now = Date.now();
-      const sensorTime = new Date(data.time).getTime();
-      const isOnline = (now - sensorTime) < 10 * 60 * 1000;
-
-      let status = isOnline ? "good" : "bad";
-      alertIcon.className = `alert-icon ${status}`;
-      alertIcon.textContent = "●";
-
-      const formatted = formatFullTime(sensorTime);
-
-      if (sensor.id === "aquarium") {
-        info.innerHTML = isOnline
-          ? `TDS: ${tds} ppm`
-          : `<span class="offline">Offline since ${formatted}</span>`;
-      } else {
-        info.innerHTML = isOnline
-          ? `Temp: ${temp}°F | Humidity: ${humidity}%`
-          : `<span class="offline">Offline since ${formatted}</span>`;
-      }
-
-      updated.textContent = `Last updated: ${formatted}`;
-    });
+function updateSensor(sensor, data) {
+  const info = document.getElementById(`info-${sensor.id}`);
+  const alertIcon = document.getElementById(`alert-${sensor.id}`);
+  const updated = document.getElementById(`last-${sensor.id}`);
+
+  if (data.error) {
+    info.innerHTML = "<span class='offline'>No data available</span>";
+    alertIcon.className = "alert-icon bad";
+    return;
+  }
+
+  const temp = parseFloat(data.temp);
+  const humidity = parseFloat(data.humidity);
+  const tds = parseFloat(data.tds || data.TDS || 0);
+  const now = Date.now();
+  const sensorTime = new Date(data.time).getTime();
+  const isOnline = (now - sensorTime) < 10 * 60 * 1000;
+
+  let status = isOnline ? "good" : "bad";
+  alertIcon.className = `alert-icon ${status}`;
+  alertIcon.textContent = "●";
+
+  const formatted = formatFullTime(sensorTime);
+
+  if (sensor.id === "aquarium") {
+    info.innerHTML = isOnline
+      ? `TDS: ${tds} ppm`
+      : `<span class="offline">Offline since ${formatted}</span>`;
+  } else {
+    info.innerHTML = isOnline
+      ? `Temp: ${temp}°F | Humidity: ${humidity}%`
+      : `<span class="offline">Offline since ${formatted}</span>`;
+  }
+
+  updated.textContent = `Last updated: ${formatted}`;
 }
 
 function loadPopupGraph(sensorId) {
-  fetch(`${base}/sensor/${sensorId}-log`)
-    .then(res => res.text())
-    .then(csv => {
-      const rows = csv.trim().split("\n");
+  const now = Date.now();
+  let cutoff = now;
+  if (currentScale === "hour") cutoff -= 1 * 60 * 60 * 1000;
+  else if (currentScale === "day") cutoff -= 24 * 60 * 60 * 1000;
+  else if (currentScale === "week") cutoff -= 7 * 24 * 60 * 60 * 1000;
+  else if (currentScale === "month") cutoff -= 30 * 24 * 60 * 60 * 1000;
+
+  const points = document.getElementById("popup-chart").clientWidth || 600;
+  fetch(`${base}/sensor/${sensorId}-rollup?from=${Math.floor(cutoff / 1000)}&to=${Math.floor(now / 1000)}&points=${points}`)
+    .then(res => res.json())
+    .then(data => {
       const labels = [], temp = [], hum = [], lux = [], tds = [];
-
-      const now = Date.now();
-      let cutoff = now;
-      if (currentScale === "hour") cutoff -= 1 * 60 * 60 * 1000;
-      else if (currentScale === "day") cutoff -= 24 * 60 * 60 * 1000;
-      else if (currentScale === "week") cutoff -= 7 * 24 * 60 * 60 * 1000;
-      else if (currentScale === "month") cutoff -= 30 * 24 * 60 * 60 * 1000;
-
-      let lastIncludedTime = 0;
-      const spacing = currentScale === "hour" ? 2 * 60 * 1000 :
-                      currentScale === "day" ? 15 * 60 * 1000 :
-                      currentScale === "week" ? 2 * 60 * 60 * 1000 :
-                      24 * 60 * 60 * 1000;
-
-      rows.forEach(r => {
-        const parts = r.split(",");
-        const time = parts[0];
-        const ts = new Date(time).getTime();
-        const hours = new Date(ts).getHours();
-
-        if (ts >= cutoff) {
-          let passFilter = true;
-          if (currentFilter === "day" && (hours < 7 || hours >= 19)) passFilter = false;
-          if (currentFilter === "night" && (hours >= 7 && hours < 19)) passFilter = false;
-
-          if (passFilter && (ts - lastIncludedTime >= spacing)) {
-            labels.push(new Date(time).toLocaleString("en-US", {
-              month: "short",
-              day: "numeric",
-              hour: "numeric",
-              minute: "numeric",
-              hour12: true
-            }));
-            temp.push(parseFloat(parts[2]));
-            hum.push(parseFloat(parts[3]));
-            if (parts.length > 4) lux.push(parseFloat(parts[4]));
-            if (parts.length > 5) tds.push(parseFloat(parts[5]));
-            lastIncludedTime = ts;
-          }
-        }
+      const hasLux = (data.lux?.count || []).some(n => n > 0);
+      const hasTds = (data.tds?.count || []).some(n => n > 0);
+
+      // One point per bucket mean. The server picks minute, hour or day
+      // buckets to fit the chart's width, so there is no thinning here.
+      (data.time || []).forEach((time, i) => {
+        const hours = new Date(time).getHours();
+        if (currentFilter === "day" && (hours < 7 || hours >= 19)) return;
+        if (currentFilter === "night" && (hours >= 7 && hours < 19)) return;
+
+        labels.push(new Date(time).toLocaleString("en-US", {
+          month: "short",
+          day: "numeric",
+          hour: "numeric",
+          minute: "numeric",
+          hour12: true
+        }));
+        temp.push(data.temp.mean[i]);
+        hum.push(data.humidity.mean[i]);
+        if (hasLux) lux.push(data.lux.mean[i]);
+        if (hasTds) tds.push(data.tds.mean[i]);
       });
 
       const ctx = document.getElementById("popup-chart").getContext('2d');
@@ -193,77 +177,167 @@ function loadPopupGraph(sensorId) {
     });
 }
 
-function refreshAll() {
-  sensors.forEach(sensor => {
-    updateSensor(sensor);
+// Time of the newest row in each mini chart. Once a chart is drawn, only
+// the rows logged after it are fetched and appended.
+const miniLast = {};
 
-    fetch(`${base}/sensor/${sensor.id}-log`)
+function updateMiniChart(sensor) {
+  if (miniCharts[sensor.id] && miniLast[sensor.id]) {
+    fetch(`${base}/sensor/${sensor.id}-log?after=${encodeURIComponent(miniLast[sensor.id])}`)
       .then(res => res.text())
       .then(csv => {
-        const rows = csv.trim().split("\n").slice(-20);
-        const labels = [], temp = [], hum = [], tds = [];
-
-        rows.forEach((r, i) => {
-          const parts = r.split(",");
-          const time = parts[0];
-          if (!time) return;
-
-          labels.push(new Date(time).toLocaleTimeString("en-US", {
-            hour: 'numeric', minute: 'numeric', hour12: true
-          }));
-          if (parts.length > 2) temp.push(parseFloat(parts[2]));
-          if (parts.length > 3) hum.push(parseFloat(parts[3]));
-          if (parts.length > 5) tds.push(parseFloat(parts[5]));
+        csv.split("\n").filter(r => r).forEach(r => {
+          const [time, , temp, humidity, , tds] = r.split(",");
+          appendMiniChart(sensor, { time, temp, humidity, tds });
         });
+      });
+    return;
+  }
+  fetch(`${base}/sensor/${sensor.id}-query?limit=20`)
+    .then(res => res.text())
+    .then(csv => {
+      const rows = csv.trim().split("\n");
+      const labels = [], temp = [], hum = [], tds = [];
 
-        const canvas = document.getElementById(`chart-${sensor.id}`);
-        if (!canvas) return;
+      rows.forEach((r, i) => {
+        const parts = r.split(",");
+        const time = parts[0];
+        if (!time) return;
+
+        labels.push(new Date(time).toLocaleTimeString("en-US", {
+          hour: 'numeric', minute: 'numeric', hour12: true
+        }));
+        if (parts.length > 2) temp.push(parseFloat(parts[2]));
+        if (parts.length > 3) hum.push(parseFloat(parts[3]));
+        if (parts.length > 5) tds.push(parseFloat(parts[5]));
+      });
 
-        const ctx = canvas.getContext('2d');
-        if (!ctx) return;
+      const canvas = document.getElementById(`chart-${sensor.id}`);
+      if (!canvas) return;
 
-        if (miniCharts[sensor.id]) miniCharts[sensor.id].destroy();
+      const ctx = canvas.getContext('2d');
+      if (!ctx) return;
 
-        let datasets;
-        if (sensor.id === "aquarium") {
-          datasets = [
-            { label: "TDS (ppm)", data: tds, borderColor: "green", fill: false }
-          ];
-        } else {
-          datasets = [
-            { label: "Temp (°F)", data: temp, borderColor: "orange", fill: false },
-            { label: "Humidity (%)", data: hum, borderColor: "lightblue", fill: false }
-          ];
-        }
+      if (miniCharts[sensor.id]) miniCharts[sensor.id].destroy();
 
-        miniCharts[sensor.id] = new Chart(ctx, {
-          type: "line",
-          data: {
-            labels: labels,
-            datasets: datasets
-          },
-          options: {
-            responsive: true,
-            maintainAspectRatio: false,
-            plugins: { legend: { display: false } },
-            scales: {
-              x: { ticks: { color: "#aaa" } },
-              y: {
-                ticks: { color: "#eee" },
-                ...(sensor.id === "aquarium" ? { min: 0, max: 500 } : {})
-              }
+      let datasets;
+      if (sensor.id === "aquarium") {
+        datasets = [
+          { label: "TDS (ppm)", data: tds, borderColor: "green", fill: false }
+        ];
+      } else {
+        datasets = [
+          { label: "Temp (°F)", data: temp, borderColor: "orange", fill: false },
+          { label: "Humidity (%)", data: hum, borderColor: "lightblue", fill: false }
+        ];
+      }
+
+      miniLast[sensor.id] = rows[rows.length - 1].split(",")[0];
+      miniCharts[sensor.id] = new Chart(ctx, {
+        type: "line",
+        data: {
+          labels: labels,
+          datasets: datasets
+        },
+        options: {
+          responsive: true,
+          maintainAspectRatio: false,
+          plugins: { legend: { display: false } },
+          scales: {
+            x: { ticks: { color: "#aaa" } },
+            y: {
+              ticks: { color: "#eee" },
+              ...(sensor.id === "aquarium" ? { min: 0, max: 500 } : {})
             }
           }
-        });
-      })
-      .catch(err => {
-        console.error(`Error loading mini chart for ${sensor.id}:`, err);
+        }
+      });
+    })
+    .catch(err => {
+      console.error(`Error loading mini chart for ${sensor.id}:`, err);
+    });
+}
+
+// Adds one reading to the end of a mini chart, keeping the last 20
+function appendMiniChart(sensor, data) {
+  const chart = miniCharts[sensor.id];
+  if (!chart) return;  // not loaded yet; the poll's -query draws it
+  if (data.time <= miniLast[sensor.id]) return;
+  miniLast[sensor.id] = data.time;
+  chart.data.labels.push(new Date(data.time).toLocaleTimeString("en-US", {
+    hour: 'numeric', minute: 'numeric', hour12: true
+  }));
+  if (sensor.id === "aquarium") {
+    chart.data.datasets[0].data.push(parseFloat(data.tds));
+  } else {
+    chart.data.datasets[0].data.push(parseFloat(data.temp));
+    chart.data.datasets[1].data.push(parseFloat(data.humidity));
+  }
+  if (chart.data.labels.length > 20) {
+    chart.data.labels.shift();
+    chart.data.datasets.forEach(ds => ds.data.shift());
+  }
+  chart.update("none");
+}
+
+// Every sensor's latest reading comes from one request. The server answers
+// 304 while nothing has changed; the tiles are still redrawn from the last
+// answer so a sensor that goes quiet turns offline.
+let latestEtag = null;
+let latestReadings = {};
+const chartTimes = {};
+
+function refreshAll() {
+  const headers = latestEtag ? { "If-None-Match": latestEtag } : {};
+  fetch(`${base}/sensors`, { headers, cache: "no-store" })
+    .then(res => {
+      if (res.status === 304) return latestReadings;
+      latestEtag = res.headers.get("ETag");
+      return res.json();
+    })
+    .then(readings => {
+      latestReadings = readings;
+      sensors.forEach(sensor => {
+        const data = readings[sensor.id];
+        updateSensor(sensor, data || { error: "no data" });
+        // Mini charts are fetched only when the sensor has a new reading
+        if (data && chartTimes[sensor.id] !== data.time) {
+          chartTimes[sensor.id] = data.time;
+          updateMiniChart(sensor);
+        }
       });
+    })
+    .catch(err => {
+      console.error("Error loading latest readings:", err);
+    });
+}
+
+// New readings are pushed as they are logged. The browser reconnects on
+// its own and the server replays what it missed; a "reset" means it missed
+// too much, so everything is fetched again. The poll stays as a slow
+// fallback, and keeps the offline state of quiet sensors up to date.
+function connectLive() {
+  const live = new EventSource(`${base}/live`);
+  live.addEventListener("open", refreshAll);
+  live.addEventListener("reset", refreshAll);
+  live.addEventListener("reading", e => {
+    const data = JSON.parse(e.data);
+    const sensor = sensors.find(s => s.id === data.sensor_id);
+    const shown = latestReadings[data.sensor_id];
+    if (!sensor || (shown && data.time < shown.time)) return;  // backlog from a node's spool
+    latestReadings[sensor.id] = data;
+    updateSensor(sensor, data);
+    // Before the poll has loaded a mini chart, leave it to the poll
+    if (miniCharts[sensor.id] && chartTimes[sensor.id] !== data.time) {
+      chartTimes[sensor.id] = data.time;
+      appendMiniChart(sensor, data);
+    }
   });
 }
 
-setInterval(refreshAll, 15000);
+setInterval(refreshAll, 60000);
 refreshAll();
+connectLive();
 
 
 // Popup controls (unchanged)
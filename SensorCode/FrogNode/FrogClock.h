@@ -0,0 +1,27 @@
+#pragma once
+
+// --- FrogClock ---
+// Wall-clock time for reading timestamps. SNTP runs in the background once
+// Wi-Fi is up; until it has synced, frogNow() returns 0 and the server
+// stamps the reading on arrival instead. A node waking from deep sleep
+// knows roughly what time it is from RTC memory (FrogSleep.h) and counts
+// from that until SNTP answers.
+
+#include <Arduino.h>
+#include <time.h>
+
+#define FROG_CLOCK_VALID_AFTER 1600000000UL  // anything earlier means "not synced"
+
+inline void frogClockBegin() {
+  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+}
+
+// Epoch seconds at millis() == 0, carried over a deep sleep; 0 = unknown.
+// Only as good as the RTC oscillator during the sleep (a few %).
+inline uint32_t frogClockBase = 0;
+
+inline uint32_t frogNow() {
+  time_t now = time(nullptr);
+  if (now > (time_t)FROG_CLOCK_VALID_AFTER) return (uint32_t)now;
+  return frogClockBase ? frogClockBase + millis() / 1000 : 0;
+}
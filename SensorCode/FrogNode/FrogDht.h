@@ -0,0 +1,318 @@
+#pragma once
+
+// --- FrogDht ---
+// DHT11/DHT22 without bit-banging. The Adafruit library held the CPU with
+// interrupts off for ~25 ms per read, back to back for every sensor on the
+// node, which upset Wi-Fi timing. Here a read is split over scheduler
+// passes and the CPU never waits on the wire:
+//
+//   start()  pull the line low to wake the sensor
+//   poll()   release it ~18 ms later (DHT11) and capture the sensor's
+//            answer in the background, then decode it on a later pass
+//
+// A DHT22 only wants ~1 ms of start pulse, shorter than a scheduler pass,
+// so start() arms a one-shot timer (esp_timer on the ESP32, Ticker on the
+// ESP8266) that releases the line from its callback.
+//
+// The capture is done by hardware where it can be:
+//
+//   ESP32    an RMT receive channel records the pulse train (1 µs ticks)
+//            and raises a callback when the line goes idle
+//   ESP8266  a CHANGE interrupt timestamps every edge; also the ESP32
+//            fallback when it runs out of RMT channels
+//
+// frogDhtDecode() turns either capture into the 5 data bytes and checks
+// the checksum. It only looks at pulse lengths, so it runs the same on the
+// host (the simulator feeds it synthesized waveforms).
+//
+// FrogNode starts every DHT on the node in the same pass, so they all
+// answer in parallel and a read of any number of sensors takes ~25 ms of
+// wall time and a few hundred µs of CPU.
+
+#include <Arduino.h>
+#if defined(ESP8266)
+#include <Ticker.h>
+#else
+#include <driver/gpio.h>
+#include <driver/rmt_rx.h>
+#include <esp_timer.h>
+#endif
+
+#ifndef DHT11
+#define DHT11 11
+#define DHT12 12
+#define DHT21 21
+#define DHT22 22
+#endif
+
+#ifndef FROG_DHT_POLL_MS
+#define FROG_DHT_POLL_MS 10
+#endif
+#define FROG_DHT11_START_MS 18   // host start pulse
+#define FROG_DHT22_START_US 1100
+#define FROG_DHT_FRAME_US 6000   // response + 40 bits is at most ~5.3 ms
+#define FROG_DHT_MAX_PULSES 96   // ~85 in a good frame
+#define FROG_DHT_BIT_US 48       // high time: ~27 µs is a 0, ~70 µs a 1
+
+struct FrogPulse {
+  uint8_t level;
+  uint16_t us;
+};
+
+enum FrogDhtStatus : uint8_t {
+  FROG_DHT_OK,
+  FROG_DHT_NO_RESPONSE,  // no pulses at all: unplugged, or no pull-up
+  FROG_DHT_SHORT,        // fewer than 40 bits
+  FROG_DHT_CHECKSUM,
+};
+
+inline const char* frogDhtStatusName(FrogDhtStatus s) {
+  switch (s) {
+    case FROG_DHT_OK: return "ok";
+    case FROG_DHT_NO_RESPONSE: return "no response";
+    case FROG_DHT_SHORT: return "short frame";
+    case FROG_DHT_CHECKSUM: return "checksum";
+  }
+  return "?";
+}
+
+struct FrogDhtFrame {
+  FrogDhtStatus status;
+  uint8_t bytes[5];
+  float tempC;
+  float humidity;
+};
+
+// Decode the pulses seen on the line after the host released it. The bits
+// are the last 40 high pulses that follow a low; anything before them is
+// the release and the sensor's 80 µs response.
+inline FrogDhtFrame frogDhtDecode(const FrogPulse* pulses, uint16_t n, uint8_t type) {
+  FrogDhtFrame f = {};
+  f.tempC = NAN;
+  f.humidity = NAN;
+  uint16_t highs[40];
+  uint16_t count = 0;
+  for (uint16_t i = 1; i < n; i++) {
+    if (pulses[i].level != HIGH || pulses[i - 1].level != LOW || pulses[i].us == 0) continue;
+    highs[count % 40] = pulses[i].us;
+    count++;
+  }
+  if (count == 0) {
+    f.status = FROG_DHT_NO_RESPONSE;
+    return f;
+  }
+  if (count < 40) {
+    f.status = FROG_DHT_SHORT;
+    return f;
+  }
+  for (uint8_t b = 0; b < 40; b++) {
+    uint16_t us = highs[(count - 40 + b) % 40];
+    f.bytes[b / 8] = (uint8_t)((f.bytes[b / 8] << 1) | (us > FROG_DHT_BIT_US ? 1 : 0));
+  }
+  if ((uint8_t)(f.bytes[0] + f.bytes[1] + f.bytes[2] + f.bytes[3]) != f.bytes[4]) {
+    f.status = FROG_DHT_CHECKSUM;
+    return f;
+  }
+  if (type == DHT11 || type == DHT12) {
+    f.humidity = f.bytes[0] + f.bytes[1] * 0.1f;
+    f.tempC = f.bytes[2] + (f.bytes[3] & 0x7F) * 0.1f;
+    if (f.bytes[3] & 0x80) f.tempC = -f.tempC;
+  } else {
+    f.humidity = ((f.bytes[0] << 8) | f.bytes[1]) * 0.1f;
+    f.tempC = (((f.bytes[2] & 0x7F) << 8) | f.bytes[3]) * 0.1f;
+    if (f.bytes[2] & 0x80) f.tempC = -f.tempC;
+  }
+  f.status = FROG_DHT_OK;
+  return f;
+}
+
+class FrogDht {
+public:
+  FrogDht(uint8_t pin, uint8_t type) : _pin(pin), _type(type) {}
+
+  void begin(const char* name) {
+#if !defined(ESP8266)
+    _rmtOk = beginRmt();
+    esp_timer_create_args_t timer = {};
+    timer.callback = onStartDone;
+    timer.arg = this;
+    timer.name = "dht start";
+    _timerOk = esp_timer_create(&timer, &_timer) == ESP_OK;
+#endif
+    if (!_rmtOk) {
+      pinMode(_pin, INPUT_PULLUP);
+    }
+    Serial.printf("[INIT] DHT '%s' on GPIO%d (%s)\n", name, _pin, _rmtOk ? "RMT" : "pin interrupts");
+  }
+
+  // Wake the sensor. Does nothing while the previous read is still going.
+  void start() {
+    if (_phase != IDLE) return;
+    lineLow();
+    _startMs = millis();
+    _phase = WAKING;
+    if (!timedStart()) return;
+#if defined(ESP8266)
+    _timer.once_ms((FROG_DHT22_START_US + 999) / 1000, onStartDone, (void*)this);
+#else
+    esp_timer_start_once(_timer, FROG_DHT22_START_US);
+#endif
+  }
+
+  // Step the read along. Returns true once, when frame() has the result.
+  bool poll() {
+    if (_phase == WAKING) {
+      // Without a timer a DHT22's pulse just runs to the next pass; it
+      // accepts up to ~20 ms.
+      uint32_t startMs = _type == DHT11 ? FROG_DHT11_START_MS : FROG_DHT22_START_US / 1000 + 1;
+      if (!timedStart() && millis() - _startMs >= startMs) release();
+      return false;
+    }
+    if (_phase != RECEIVING) return false;
+    uint32_t elapsed = micros() - _releaseUs;
+    bool done = _rmtOk ? _rxDone : elapsed >= FROG_DHT_FRAME_US;
+    if (!done && elapsed < 4 * FROG_DHT_FRAME_US) return false;
+
+    FrogPulse pulses[FROG_DHT_MAX_PULSES];
+    uint16_t n = stopCapture(pulses);
+    _frame = frogDhtDecode(pulses, n, _type);
+    _phase = IDLE;
+    _counts[_frame.status]++;
+    return true;
+  }
+
+  const FrogDhtFrame& frame() const { return _frame; }
+
+  void printStats(Print& out, const char* name) const {
+    out.printf("[DHT] %s ok=%lu no-response=%lu short=%lu checksum=%lu (%s)\n", name,
+               (unsigned long)_counts[FROG_DHT_OK], (unsigned long)_counts[FROG_DHT_NO_RESPONSE],
+               (unsigned long)_counts[FROG_DHT_SHORT], (unsigned long)_counts[FROG_DHT_CHECKSUM],
+               _rmtOk ? "RMT" : "pin interrupts");
+  }
+
+private:
+  enum Phase : uint8_t { IDLE, WAKING, RECEIVING };
+
+  bool timedStart() const { return _type != DHT11 && _timerOk; }
+
+  // Ends a DHT22's start pulse, from the timer task (ESP32) or the SDK's
+  // timer context (ESP8266).
+  static void onStartDone(void* arg) {
+    FrogDht* d = (FrogDht*)arg;
+    if (d->_phase == WAKING) d->release();
+  }
+
+  void lineLow() {
+#if !defined(ESP8266)
+    if (_rmtOk) {
+      gpio_set_level((gpio_num_t)_pin, 0);
+      return;
+    }
+#endif
+    pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, LOW);
+  }
+
+  // Let the line go and listen for the answer.
+  void release() {
+    _edgeCount = 0;
+    _rxDone = false;
+#if !defined(ESP8266)
+    if (_rmtOk) {
+      rmt_receive_config_t rx = {};
+      rx.signal_range_min_ns = 1000;       // shorter is a glitch
+      rx.signal_range_max_ns = 1000000;    // a level this long ends the frame
+      rmt_receive(_rmt, _symbols, sizeof(_symbols), &rx);
+      gpio_set_level((gpio_num_t)_pin, 1);
+      _releaseUs = micros();
+      _phase = RECEIVING;
+      return;
+    }
+#endif
+    pinMode(_pin, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(_pin), onEdge, this, CHANGE);
+    _releaseUs = micros();
+    _phase = RECEIVING;
+  }
+
+  // The capture as pulses, oldest first. Ends the capture.
+  uint16_t stopCapture(FrogPulse* out) {
+    uint16_t n = 0;
+#if !defined(ESP8266)
+    if (_rmtOk) {
+      if (!_rxDone) {  // no answer; reset the channel
+        rmt_disable(_rmt);
+        rmt_enable(_rmt);
+      }
+      uint16_t symbols = _rxDone ? _rxSymbols : 0;
+      for (uint16_t i = 0; i < symbols && n + 2 <= FROG_DHT_MAX_PULSES; i++) {
+        out[n++] = {(uint8_t)_symbols[i].level0, (uint16_t)_symbols[i].duration0};
+        out[n++] = {(uint8_t)_symbols[i].level1, (uint16_t)_symbols[i].duration1};
+      }
+      return n;
+    }
+#endif
+    detachInterrupt(digitalPinToInterrupt(_pin));
+    // The first edge after the release is the sensor pulling the line low.
+    for (uint16_t i = 1; i < _edgeCount; i++) {
+      out[n++] = {(uint8_t)(i % 2 == 1 ? LOW : HIGH), (uint16_t)(_edgeUs[i] - _edgeUs[i - 1])};
+    }
+    return n;
+  }
+
+  static void IRAM_ATTR onEdge(void* arg) {
+    FrogDht* d = (FrogDht*)arg;
+    if (d->_edgeCount < FROG_DHT_MAX_PULSES) d->_edgeUs[d->_edgeCount++] = micros();
+  }
+
+#if !defined(ESP8266)
+  bool beginRmt() {
+    rmt_rx_channel_config_t cfg = {};
+    cfg.gpio_num = (gpio_num_t)_pin;
+    cfg.clk_src = RMT_CLK_SRC_DEFAULT;
+    cfg.resolution_hz = 1000000;
+    cfg.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL;
+    if (rmt_new_rx_channel(&cfg, &_rmt) != ESP_OK) return false;
+    rmt_rx_event_callbacks_t callbacks = {};
+    callbacks.on_recv_done = onRmtDone;
+    rmt_rx_register_event_callbacks(_rmt, &callbacks, this);
+    rmt_enable(_rmt);
+    // Open drain with the input still routed to the RMT, so it hears the
+    // line while we drive it.
+    gpio_set_direction((gpio_num_t)_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode((gpio_num_t)_pin, GPIO_PULLUP_ONLY);
+    gpio_set_level((gpio_num_t)_pin, 1);
+    return true;
+  }
+
+  static bool IRAM_ATTR onRmtDone(rmt_channel_handle_t, const rmt_rx_done_event_data_t* e, void* arg) {
+    FrogDht* d = (FrogDht*)arg;
+    d->_rxSymbols = (uint16_t)e->num_symbols;
+    d->_rxDone = true;
+    return false;
+  }
+
+  rmt_channel_handle_t _rmt = nullptr;
+  rmt_symbol_word_t _symbols[FROG_DHT_MAX_PULSES / 2];
+#endif
+
+#if defined(ESP8266)
+  Ticker _timer;
+  bool _timerOk = true;
+#else
+  esp_timer_handle_t _timer = nullptr;
+  bool _timerOk = false;
+#endif
+  uint8_t _pin;
+  uint8_t _type;
+  bool _rmtOk = false;
+  volatile Phase _phase = IDLE;  // release() may run from the start timer
+  uint32_t _startMs = 0;
+  uint32_t _releaseUs = 0;
+  volatile bool _rxDone = false;
+  volatile uint16_t _rxSymbols = 0;
+  volatile uint16_t _edgeCount = 0;
+  volatile uint32_t _edgeUs[FROG_DHT_MAX_PULSES];
+  FrogDhtFrame _frame = {};
+  uint32_t _counts[4] = {};
+};
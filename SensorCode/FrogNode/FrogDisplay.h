@@ -0,0 +1,310 @@
+#pragma once
+
+// --- FrogDisplay ---
+// Retained-mode text for the node displays. Clearing the panel and
+// redrawing every line each cycle sent a full frame every time: 25.6 KB
+// over SPI for the 160x80 ST7735, and 1 KB over I2C for an SSD1306. The
+// full clear also made the TFT flicker.
+//
+// A screen here is a list of text widgets (position, width in characters,
+// colour). The sketch sets their text and colour whenever it likes;
+// render() compares against what is on the panel and sends only the
+// difference:
+//
+//   FrogTftScreen   ST7735/ST7789, no framebuffer. Each run of changed
+//                   character cells is drawn into a small canvas and sent
+//                   as one address window.
+//   FrogOledScreen  SSD1306. Widgets draw into the library's framebuffer.
+//                   The buffer is compared with a copy of what was last
+//                   sent, and only the changed columns of each changed
+//                   8-pixel page go out.
+//
+// Line widgets (addLines) also take Print output top to bottom, so
+// node.printSummary(screen) works as it did on the raw display.
+//
+// Bytes per frame, and what a full redraw would have cost, are printed as
+// a [DISPLAY] line every minute.
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+#include <stdarg.h>
+
+#ifndef FROG_WIDGETS
+#define FROG_WIDGETS 16
+#endif
+#ifndef FROG_WIDGET_COLS
+#define FROG_WIDGET_COLS 26  // 160 px of the built-in 6x8 font
+#endif
+#define FROG_DISPLAY_STATS_MS 60000
+
+struct FrogWidget {
+  int16_t x;
+  int16_t y;
+  uint8_t cols;
+  bool line;  // filled by Print
+  uint16_t color;
+  uint16_t shownColor;
+  char text[FROG_WIDGET_COLS + 1];
+  char shown[FROG_WIDGET_COLS + 1];  // what the panel has, space padded
+};
+
+class FrogWidgets : public Print {
+public:
+  // Returns the widget's id, or -1 when FROG_WIDGETS are taken.
+  int8_t add(int16_t x, int16_t y, uint8_t cols, uint16_t color = 0xFFFF) {
+    if (_count >= FROG_WIDGETS) return -1;
+    FrogWidget& w = _widgets[_count];
+    w = FrogWidget{};
+    w.x = x;
+    w.y = y;
+    w.cols = cols > FROG_WIDGET_COLS ? FROG_WIDGET_COLS : cols;
+    w.color = color;
+    w.shownColor = color;
+    memset(w.shown, ' ', w.cols);
+    return (int8_t)_count++;
+  }
+
+  // Rows of 8 px that Print output fills in order. Returns the first id.
+  int8_t addLines(int16_t x, int16_t y, uint8_t rows, uint8_t cols, uint16_t color = 0xFFFF) {
+    int8_t first = -1;
+    for (uint8_t r = 0; r < rows; r++) {
+      int8_t id = add(x, y + r * 8, cols, color);
+      if (id < 0) break;
+      _widgets[id].line = true;
+      if (first < 0) first = id;
+    }
+    return first;
+  }
+
+  void setText(uint8_t id, const char* fmt, ...) {
+    if (id >= _count) return;
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(_widgets[id].text, _widgets[id].cols + 1, fmt, args);
+    va_end(args);
+  }
+
+  void setColor(uint8_t id, uint16_t color) {
+    if (id < _count) _widgets[id].color = color;
+  }
+
+  // Empty the line widgets and start printing at the first one.
+  void beginLines() {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_widgets[i].line) _widgets[i].text[0] = '\0';
+    }
+    _line = nextLine(0);
+    _col = 0;
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      _line = nextLine(_line + 1);
+      _col = 0;
+      return 1;
+    }
+    if (c == '\r' || _line >= _count) return 1;
+    FrogWidget& w = _widgets[_line];
+    if (_col < w.cols) {
+      w.text[_col++] = (char)c;
+      w.text[_col] = '\0';
+    }
+    return 1;
+  }
+  using Print::write;
+
+  uint32_t lastFrameBytes() const { return _lastBytes; }
+
+  void printStats(Print& out) const {
+    out.printf("[DISPLAY] frames=%lu last=%luB avg=%luB full=%luB\n", (unsigned long)_frames,
+               (unsigned long)_lastBytes, (unsigned long)(_frames ? _bytes / _frames : 0),
+               (unsigned long)_fullBytes);
+  }
+
+protected:
+  uint8_t nextLine(uint8_t from) const {
+    while (from < _count && !_widgets[from].line) from++;
+    return from;
+  }
+
+  // The character at col as it should look: text, then spaces.
+  static char cell(const FrogWidget& w, uint8_t col) {
+    size_t len = strnlen(w.text, w.cols);
+    return col < len ? w.text[col] : ' ';
+  }
+
+  // Does col have to be sent again?
+  static bool changed(const FrogWidget& w, uint8_t col) {
+    char c = cell(w, col);
+    if (c != w.shown[col]) return true;
+    return c != ' ' && w.color != w.shownColor;
+  }
+
+  void endFrame(uint32_t bytes) {
+    _frames++;
+    _bytes += bytes;
+    _lastBytes = bytes;
+    if (millis() - _statsAt >= FROG_DISPLAY_STATS_MS) {
+      _statsAt = millis();
+      printStats(Serial);
+    }
+  }
+
+  FrogWidget _widgets[FROG_WIDGETS];
+  uint8_t _count = 0;
+  uint8_t _line = 0;
+  uint8_t _col = 0;
+  uint32_t _frames = 0;
+  uint32_t _bytes = 0;
+  uint32_t _lastBytes = 0;
+  uint32_t _fullBytes = 0;  // one whole-panel redraw
+  uint32_t _statsAt = 0;
+};
+
+// --- TFT (ST7735 / ST7789) ---
+template <class Panel>
+class FrogTftScreen : public FrogWidgets {
+public:
+  static constexpr uint32_t kWindowBytes = 11;  // CASET + RASET + RAMWR
+
+  FrogTftScreen(Panel& panel, uint16_t background = 0) : _panel(panel), _bg(background) {}
+
+  // Once, after the panel is initialised and rotated.
+  void begin() {
+    _fullBytes = kWindowBytes + (uint32_t)_panel.width() * _panel.height() * 2;
+    _panel.fillScreen(_bg);
+    endFrame(_fullBytes);
+  }
+
+  void render() {
+    uint32_t bytes = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      FrogWidget& w = _widgets[i];
+      uint8_t col = 0;
+      while (col < w.cols) {
+        if (!changed(w, col)) {
+          col++;
+          continue;
+        }
+        uint8_t end = col + 1;
+        while (end < w.cols && changed(w, end)) end++;
+        bytes += sendRun(w, col, end);
+        col = end;
+      }
+      w.shownColor = w.color;
+    }
+    endFrame(bytes);
+  }
+
+private:
+  // Draw cells [from, to) of w into the canvas and push them as one window.
+  uint32_t sendRun(FrogWidget& w, uint8_t from, uint8_t to) {
+    int16_t width = (to - from) * 6;
+    _canvas.fillScreen(_bg);
+    _canvas.setTextColor(w.color, _bg);
+    _canvas.setCursor(0, 0);
+    for (uint8_t c = from; c < to; c++) {
+      char ch = cell(w, c);
+      _canvas.write((uint8_t)ch);
+      w.shown[c] = ch;
+    }
+    // Pack the rows so the run is contiguous for drawRGBBitmap().
+    uint16_t* px = _canvas.getBuffer();
+    for (int16_t row = 1; row < 8; row++) {
+      memmove(px + row * width, px + row * _canvas.width(), width * sizeof(uint16_t));
+    }
+    _panel.drawRGBBitmap(w.x + from * 6, w.y, px, width, 8);
+    return kWindowBytes + (uint32_t)width * 8 * 2;
+  }
+
+  Panel& _panel;
+  uint16_t _bg;
+  GFXcanvas16 _canvas{FROG_WIDGET_COLS * 6, 8};
+};
+
+// --- OLED (SSD1306) ---
+// Monochrome: any non-zero widget colour is lit.
+template <class Panel>
+class FrogOledScreen : public FrogWidgets {
+public:
+  // SSD1306 commands and colours; the sketch may not include the driver
+  // before this header.
+  static constexpr uint8_t kColumnAddr = 0x21;
+  static constexpr uint8_t kPageAddr = 0x22;
+  static constexpr uint16_t kOn = 1;
+  static constexpr uint16_t kOff = 0;
+
+  FrogOledScreen(Panel& panel, uint8_t i2cAddr, TwoWire& wire = Wire) : _panel(panel), _addr(i2cAddr), _wire(wire) {}
+
+  // Once, after panel.begin(). Sends one blank frame the usual way.
+  void begin() {
+    _pages = (_panel.height() + 7) / 8;
+    uint32_t size = (uint32_t)_panel.width() * _pages;
+    _shadow = (uint8_t*)calloc(size, 1);
+    _fullBytes = size + (size + 31) / 32 + 12;
+    _panel.clearDisplay();
+    _panel.display();
+    endFrame(_fullBytes);
+  }
+
+  void render() {
+    for (uint8_t i = 0; i < _count; i++) {
+      FrogWidget& w = _widgets[i];
+      bool dirty = w.color != w.shownColor;
+      for (uint8_t c = 0; c < w.cols && !dirty; c++) dirty = changed(w, c);
+      if (!dirty) continue;
+      _panel.fillRect(w.x, w.y, w.cols * 6, 8, kOff);
+      _panel.setTextColor(w.color ? kOn : kOff);
+      _panel.setCursor(w.x, w.y);
+      for (uint8_t c = 0; c < w.cols; c++) {
+        w.shown[c] = cell(w, c);
+        if (w.shown[c] != ' ') _panel.write((uint8_t)w.shown[c]);
+        else _panel.setCursor(_panel.getCursorX() + 6, w.y);
+      }
+      w.shownColor = w.color;
+    }
+    endFrame(flush());
+  }
+
+private:
+  // Send the columns of each page that differ from what the panel has.
+  uint32_t flush() {
+    if (!_shadow) return 0;
+    const uint8_t* buf = _panel.getBuffer();
+    int16_t width = _panel.width();
+    uint32_t bytes = 0;
+    for (uint8_t page = 0; page < _pages; page++) {
+      const uint8_t* row = buf + page * width;
+      uint8_t* seen = _shadow + page * width;
+      int16_t lo = 0, hi = width - 1;
+      while (lo < width && row[lo] == seen[lo]) lo++;
+      if (lo == width) continue;
+      while (row[hi] == seen[hi]) hi--;
+
+      _panel.ssd1306_command(kPageAddr);
+      _panel.ssd1306_command(page);
+      _panel.ssd1306_command(page);
+      _panel.ssd1306_command(kColumnAddr);
+      _panel.ssd1306_command(lo);
+      _panel.ssd1306_command(hi);
+      bytes += 12;
+      for (int16_t x = lo; x <= hi;) {
+        _wire.beginTransmission(_addr);
+        _wire.write((uint8_t)0x40);  // data follows
+        int16_t n = 0;
+        for (; n < 31 && x <= hi; n++, x++) _wire.write(row[x]);
+        _wire.endTransmission();
+        bytes += 1 + n;
+      }
+      memcpy(seen + lo, row + lo, hi - lo + 1);
+    }
+    return bytes;
+  }
+
+  Panel& _panel;
+  uint8_t _addr;
+  TwoWire& _wire;
+  uint8_t _pages = 0;
+  uint8_t* _shadow = nullptr;
+};
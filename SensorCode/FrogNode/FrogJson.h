@@ -0,0 +1,156 @@
+#pragma once
+
+// --- FrogJson ---
+// Builds the /api/sensor JSON array straight into a fixed char buffer.
+// No Arduino String, no malloc: the buffer is normally a FrogJsonBuffer<N>
+// on the stack, and numbers are formatted as fixed-point by hand instead of
+// going through dtostrf/printf.
+//
+//   FrogJsonBuffer<384> batch;
+//   batch.add(FrogReading("Bedroom").set(CH_TEMP, 71.6).set(CH_HUMIDITY, 40));
+//   batch.finish();
+//   uplink.post(batch.c_str(), batch.length());
+//
+// A reading that would not fit is dropped whole (overflowed() turns true),
+// so the buffer always holds a valid JSON array.
+
+#include <FrogReading.h>
+
+class FrogJsonWriter {
+public:
+  FrogJsonWriter(char* buf, size_t cap) : _buf(buf), _cap(cap) { reset(); }
+
+  void reset() {
+    _len = 0;
+    _count = 0;
+    _overflow = false;
+    _closed = false;
+    put('[');
+    _buf[_len] = '\0';
+  }
+
+  // Append one reading as an object; only channels that are present are written.
+  bool add(const FrogReading& r) {
+    if (_closed) return false;
+    size_t mark = _len;
+    bool fits = true;
+    if (_count > 0) fits &= put(',');
+    fits &= put("{\"sensor\":\"");
+    fits &= putEscaped(r.sensor);
+    fits &= put('"');
+    if (r.ts) {
+      fits &= put(",\"ts\":");
+      fits &= putUint(r.ts);
+    }
+    if (r.seq) {
+      fits &= put(",\"seq\":");
+      fits &= putUint(r.seq);
+    }
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      if (!r.has((FrogChannel)c)) continue;
+      fits &= put(",\"");
+      fits &= put(kFrogFields[c].key);
+      fits &= put("\":");
+      fits &= putFixed(r.value[c], kFrogFields[c].decimals);
+    }
+    fits &= put('}');
+    // Keep one byte for the closing ']' and one for the terminator.
+    if (!fits || _len + 2 > _cap) {
+      _len = mark;
+      _buf[_len] = '\0';
+      _overflow = true;
+      return false;
+    }
+    _count++;
+    _buf[_len] = '\0';
+    return true;
+  }
+
+  // Close the array. Safe to call more than once.
+  const char* finish() {
+    if (!_closed) {
+      _buf[_len++] = ']';
+      _buf[_len] = '\0';
+      _closed = true;
+    }
+    return _buf;
+  }
+
+  const char* c_str() const { return _buf; }
+  size_t length() const { return _len; }
+  uint16_t count() const { return _count; }
+  bool overflowed() const { return _overflow; }
+
+private:
+  bool put(char c) {
+    if (_len + 1 >= _cap) return false;
+    _buf[_len++] = c;
+    return true;
+  }
+
+  bool put(const char* s) {
+    while (*s) {
+      if (!put(*s++)) return false;
+    }
+    return true;
+  }
+
+  bool putEscaped(const char* s) {
+    for (; *s; s++) {
+      if ((*s == '"' || *s == '\\') && !put('\\')) return false;
+      if (!put(*s)) return false;
+    }
+    return true;
+  }
+
+  // Fixed-point text for v with the given number of decimals (0..4).
+  bool putFixed(float v, uint8_t decimals) {
+    static const uint32_t kScale[] = {1, 10, 100, 1000, 10000};
+    if (decimals > 4) decimals = 4;
+    if (isinf(v) || fabsf(v) > 1e9f) return put("null");
+    if (v < 0) {
+      if (!put('-')) return false;
+      v = -v;
+    }
+    uint32_t scale = kScale[decimals];
+    uint32_t scaled = (uint32_t)(v * scale + 0.5f);
+    if (!putUint(scaled / scale)) return false;
+    if (decimals == 0) return true;
+    if (!put('.')) return false;
+    uint32_t frac = scaled % scale;
+    for (uint32_t div = scale / 10; div > 0; div /= 10) {
+      if (!put((char)('0' + (frac / div) % 10))) return false;
+    }
+    return true;
+  }
+
+  bool putUint(uint32_t n) {
+    char tmp[10];
+    uint8_t i = 0;
+    do {
+      tmp[i++] = (char)('0' + n % 10);
+      n /= 10;
+    } while (n);
+    while (i) {
+      if (!put(tmp[--i])) return false;
+    }
+    return true;
+  }
+
+  char* _buf;
+  size_t _cap;
+  size_t _len = 0;
+  uint16_t _count = 0;
+  bool _overflow = false;
+  bool _closed = false;
+};
+
+// A writer that owns its storage, meant to live on the stack.
+template <size_t N>
+class FrogJsonBuffer : public FrogJsonWriter {
+public:
+  FrogJsonBuffer() : FrogJsonWriter(_storage, N) {}
+
+private:
+  char _storage[N];
+};
@@ -0,0 +1,681 @@
+#pragma once
+
+// --- FrogNode ---
+// A whole sensor node generated from one constexpr table. The sketch lists
+// its sensors and what each one has wired to it; the device objects, the
+// sampling tasks, the JSON batch, the uplink, the spool and Wi-Fi upkeep
+// all come from here:
+//
+//   constexpr FrogNodeConfig kNode = {"Office Node", "ssid", "pass",
+//                                     "https://averyizatt.com/frogtank/api/sensor"};
+//   constexpr FrogSensorSpec kSensors[] = {
+//     frogSensor("White Tree Frog Terrarium").dht(4).bh1750(0x23),
+//     frogSensor("Bedroom").dht(5),
+//   };
+//   FrogNode<kNode, kSensors> node;
+//
+//   void setup() { node.begin(); }
+//   void loop()  { node.run(); }
+//
+// Each table entry becomes a FrogSensorSlot. A slot only has members and
+// read code for the parts its entry declares (if constexpr), so nothing
+// branches on "which sensor is this" at run time. Needs C++17 (ESP32 core
+// 3.x, ESP8266 core 3.x).
+//
+// A node without a display can deep sleep between reports instead (see
+// FrogSleep.h):
+//
+//   constexpr FrogNodeConfig kNode = FrogNodeConfig{"Office Node", ...}.deepSleep();
+//
+// and a dual-core ESP32 can give the uplink a core of its own, so a slow
+// server never holds up the sensors or the display (see FrogPipeline.h):
+//
+//   constexpr FrogNodeConfig kNode = FrogNodeConfig{"Living Room Node", ...}.dualCore();
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <BH1750.h>
+#include <tuple>
+#include <utility>
+#include <FrogReading.h>
+#include <FrogUplink.h>
+#include <FrogSpool.h>
+#include <FrogScheduler.h>
+#include <FrogSleep.h>
+#include <FrogDht.h>
+#include <FrogTds.h>
+#include <FrogSonar.h>
+#include <FrogPipeline.h>
+
+#ifndef FROG_SAMPLE_MS
+#define FROG_SAMPLE_MS 2500  // DHT11 needs >= 1 s between reads
+#endif
+#ifndef FROG_FAST_MS
+#define FROG_FAST_MS 1000    // light, TDS, water level
+#endif
+#ifndef FROG_REPORT_MS
+#define FROG_REPORT_MS 10000
+#endif
+#ifndef FROG_HEARTBEAT_S
+#define FROG_HEARTBEAT_S 300  // every channel is sent at least this often
+#endif
+#ifndef FROG_WIFI_TIMEOUT_MS
+#define FROG_WIFI_TIMEOUT_MS 10000
+#endif
+
+#define FROG_NO_PIN 0xFF
+
+struct FrogNodeConfig {
+  const char* label;     // printed at boot
+  const char* ssid;
+  const char* password;
+  const char* server;    // https://host/frogtank/api/sensor
+  int8_t sda = -1;       // I2C pins, -1 = board default
+  int8_t scl = -1;
+  uint32_t i2cHz = 0;    // 0 = core default
+  bool sleepBetweenReports = false;
+  bool networkCore = false;  // uplink on its own core (where there are two)
+  FrogFormat format = FROG_JSON;
+
+  constexpr FrogNodeConfig deepSleep() const {
+    FrogNodeConfig c = *this;
+    c.sleepBetweenReports = true;
+    return c;
+  }
+  constexpr FrogNodeConfig dualCore() const {
+    FrogNodeConfig c = *this;
+    c.networkCore = true;
+    return c;
+  }
+  // POST body format (FrogPack.h). The binary ones need every sensor in
+  // kFrogSensorIds.
+  constexpr FrogNodeConfig payload(FrogFormat f) const {
+    FrogNodeConfig c = *this;
+    c.format = f;
+    return c;
+  }
+};
+
+// What is wired to one logical sensor (one row in the CSV logs).
+struct FrogSensorSpec {
+  const char* name = nullptr;
+  uint8_t dhtPin = FROG_NO_PIN;
+  uint8_t dhtType = DHT11;
+  uint8_t luxAddr = 0;
+  uint8_t tdsPin = FROG_NO_PIN;
+  float tdsTempC = 25;    // water temperature for TDS compensation
+  const FrogCalPoint* tdsCal = kFrogAdcCal;
+  uint8_t tdsCalCount = sizeof(kFrogAdcCal) / sizeof(kFrogAdcCal[0]);
+  uint8_t trigPin = FROG_NO_PIN;
+  uint8_t echoPin = FROG_NO_PIN;
+  float tankFullCm = 0;   // echo distance at 0 % water
+  FrogLimit limit[CH_COUNT] = {};
+  float deadbands[CH_COUNT] = {
+    kFrogFields[CH_TEMP].deadband, kFrogFields[CH_HUMIDITY].deadband, kFrogFields[CH_LUX].deadband,
+    kFrogFields[CH_TDS].deadband, kFrogFields[CH_WATER_LEVEL].deadband,
+  };
+
+  constexpr FrogSensorSpec dht(uint8_t pin, uint8_t type = DHT11) const {
+    FrogSensorSpec s = *this;
+    s.dhtPin = pin;
+    s.dhtType = type;
+    return s;
+  }
+  constexpr FrogSensorSpec bh1750(uint8_t addr = 0x23) const {
+    FrogSensorSpec s = *this;
+    s.luxAddr = addr;
+    return s;
+  }
+  constexpr FrogSensorSpec tds(uint8_t pin, float waterTempC = 25) const {
+    FrogSensorSpec s = *this;
+    s.tdsPin = pin;
+    s.tdsTempC = waterTempC;
+    return s;
+  }
+  // The board's own ADC transfer curve (raw code -> mV), measured against
+  // a few known voltages; the default is a typical ESP32.
+  template <size_t N>
+  constexpr FrogSensorSpec tdsCalibration(const FrogCalPoint (&table)[N]) const {
+    static_assert(N >= 2 && N <= 255, "a calibration table needs 2-255 points");
+    FrogSensorSpec s = *this;
+    s.tdsCal = table;
+    s.tdsCalCount = N;
+    return s;
+  }
+  constexpr FrogSensorSpec ultrasonic(uint8_t trig, uint8_t echo, float fullCm) const {
+    FrogSensorSpec s = *this;
+    s.trigPin = trig;
+    s.echoPin = echo;
+    s.tankFullCm = fullCm;
+    return s;
+  }
+
+  // Same numbers as the sensor's entry in `thresholds` (app.py). Only
+  // deep-sleeping nodes use them, to wake sooner when a value heads there.
+  constexpr FrogSensorSpec limits(FrogChannel c, float lo, float hi) const {
+    FrogSensorSpec s = *this;
+    s.limit[c].lo = lo;
+    s.limit[c].hi = hi;
+    return s;
+  }
+
+  // A channel is only sent again once it has moved this far (or at the
+  // FROG_HEARTBEAT_S heartbeat). 0 sends every report.
+  constexpr FrogSensorSpec deadband(FrogChannel c, float band) const {
+    FrogSensorSpec s = *this;
+    s.deadbands[c] = band;
+    return s;
+  }
+
+  constexpr bool hasDht() const { return dhtPin != FROG_NO_PIN; }
+  constexpr bool hasLux() const { return luxAddr != 0; }
+  constexpr bool hasTds() const { return tdsPin != FROG_NO_PIN; }
+  constexpr bool hasLevel() const { return trigPin != FROG_NO_PIN; }
+  constexpr bool hasFast() const { return hasLux() || hasTds() || hasLevel(); }
+};
+
+constexpr FrogSensorSpec frogSensor(const char* name) {
+  FrogSensorSpec s{};
+  s.name = name;
+  return s;
+}
+
+// A device object that only exists when the table asks for it. The empty
+// version swallows the constructor arguments and takes no real space.
+template <class T, bool Enabled>
+struct FrogPart {
+  template <class... A>
+  constexpr FrogPart(A...) {}
+};
+
+template <class T>
+struct FrogPart<T, true> : T {
+  using T::T;
+};
+
+// --- FrogSensorSlot ---
+// The devices and read code for entry I of the sensor table.
+template <const auto& Sensors, size_t I>
+class FrogSensorSlot {
+public:
+  static constexpr FrogSensorSpec S = Sensors[I];
+
+  void begin() {
+    if constexpr (S.hasDht()) _dht.begin(S.name);
+    if constexpr (S.hasLux()) {
+      // BH1750::begin() takes the address again; its default (0x23) would
+      // override the one given to the constructor.
+      if (!_lux.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, S.luxAddr)) {
+        Serial.printf("[ERROR] BH1750 0x%02X for '%s' failed to initialize!\n", S.luxAddr, S.name);
+      }
+    }
+    if constexpr (S.hasTds()) _tds.begin(S.name);
+    if constexpr (S.hasLevel()) _sonar.begin(S.name);
+  }
+
+  void startDht() {
+    if constexpr (S.hasDht()) _dht.start();
+  }
+
+  // Every FROG_DHT_POLL_MS while a read is in flight.
+  void pollDht(FrogAverage& out) {
+    if constexpr (S.hasDht()) {
+      if (!_dht.poll()) return;
+      const FrogDhtFrame& f = _dht.frame();
+      if (f.status != FROG_DHT_OK) {
+        Serial.printf("[%s] Failed to read from DHT sensor! (%s)\n", S.name, frogDhtStatusName(f.status));
+        return;
+      }
+      out.add(CH_TEMP, f.tempC * 1.8f + 32.0f);
+      out.add(CH_HUMIDITY, f.humidity);
+      _airTempC = f.tempC;
+    }
+  }
+
+  void sampleFast(FrogAverage& out) {
+    if constexpr (S.hasLux()) {
+      float lux = _lux.readLightLevel();
+      if (lux >= 0) out.add(CH_LUX, lux);
+    }
+    if constexpr (S.hasTds()) {
+      float ppm = _tds.read();  // NAN until the next ADC burst is in
+      if (!isnan(ppm)) out.add(CH_TDS, ppm);
+    }
+    if constexpr (S.hasLevel()) _sonar.start(_airTempC);
+  }
+
+  // Every FROG_SONAR_GAP_MS; the level lands in the average once a burst
+  // of pings is done.
+  void sampleSonar(FrogAverage& out) {
+    float level = _sonar.poll();
+    if (!isnan(level)) out.add(CH_WATER_LEVEL, level);
+  }
+
+  void printStats(Print& out) {
+    if constexpr (S.hasDht()) _dht.printStats(out, S.name);
+    if constexpr (S.hasTds()) _tds.printStats(out, S.name);
+    if constexpr (S.hasLevel()) _sonar.printStats(out, S.name);
+  }
+
+private:
+  FrogPart<FrogDht, S.hasDht()> _dht{S.dhtPin, S.dhtType};
+  FrogPart<BH1750, S.hasLux()> _lux{S.luxAddr};
+  FrogPart<FrogTds, S.hasTds()> _tds{S.tdsPin, S.tdsTempC, S.tdsCal, S.tdsCalCount};
+  FrogPart<FrogSonar, S.hasLevel()> _sonar{S.trigPin, S.echoPin, S.tankFullCm};
+  float _airTempC = NAN;  // from the DHT, for the speed of sound
+};
+
+// --- FrogNode ---
+template <const FrogNodeConfig& Config, const auto& Sensors>
+class FrogNode {
+public:
+  static constexpr uint8_t kCount = sizeof(Sensors) / sizeof(Sensors[0]);
+  static_assert(kCount <= FROG_RTC_SENSORS, "raise FROG_RTC_SENSORS for this many sensors");
+  static_assert(kCount <= FROG_PIPE_DEPTH, "raise FROG_PIPE_DEPTH for this many sensors");
+  static_assert(!(Config.networkCore && Config.sleepBetweenReports),
+                "a deep-sleeping node reports once per wake; it has no uplink to move");
+  static constexpr bool kPipelined = Config.networkCore && FROG_DUAL_CORE;
+
+  void begin() {
+    static_assert(Config.format == FROG_JSON || allHaveIds(),
+                  "a sensor has no wire ID: add it to kFrogSensorIds (FrogPack.h) and sensor_ids (app.py)");
+    static_assert(sensorTasks() < FROG_MAX_TASKS,
+                  "raise FROG_MAX_TASKS: this sensor table leaves no room for a sketch task");
+    _self = this;
+    Serial.begin(115200);
+    delay(500);
+    Serial.printf("\n[BOOT] %s starting...\n", Config.label);
+
+    for (uint8_t i = 0; i < kCount; i++) {
+      _names[i] = Sensors[i].name;
+      _ids[i] = frogSensorId(Sensors[i].name);
+    }
+    _rtc.begin(frogTableHash(_names, kCount));
+
+    if constexpr (needsI2c()) {
+      if (Config.sda >= 0) {
+        Wire.begin(Config.sda, Config.scl);
+      } else {
+        Wire.begin();
+      }
+      if (Config.i2cHz) Wire.setClock(Config.i2cHz);
+    }
+
+    Serial.println("[WIFI] Connecting...");
+    if constexpr (Config.sleepBetweenReports) {
+      _rtc.beginWifi(Config.ssid, Config.password);
+    } else {
+      WiFi.begin(Config.ssid, Config.password);
+      _wifiAttemptStart = millis();
+    }
+    frogClockBegin();
+    _uplink.begin(Config.server, Config.format);
+    _spool.begin(_names, _ids, kCount);
+
+    beginSlots(std::make_index_sequence<kCount>{});
+    if constexpr (hasDht()) {
+      // All DHTs are read together. They get a second after boot to
+      // settle; a deep-sleeping node only has FROG_AWAKE_MS, so that is
+      // all they get there.
+      constexpr uint32_t settleMs = Config.sleepBetweenReports ? 1000 : 2000;
+      _scheduler.add("dht", FROG_SAMPLE_MS, 500, dhtTask, 0, settleMs);
+      _scheduler.add("dht rx", FROG_DHT_POLL_MS, 5, dhtPollTask, 0, settleMs);
+    }
+
+    if constexpr (Config.sleepBetweenReports) {
+      _scheduler.add("cycle", 100, 50, cycleTask);
+      _awakeSince = millis();
+      return;
+    }
+    _scheduler.add("report", FROG_REPORT_MS, 5000, reportTask, 0, FROG_REPORT_MS);
+    _scheduler.add("stats", 60000, 100, statsTask, 0, 60000);
+    netScheduler().add("wifi", 1000, 100, wifiTask);
+    netScheduler().add("spool", FROG_SPOOL_DRAIN_MS, 5000, drainTask);
+#if FROG_DUAL_CORE
+    if constexpr (kPipelined) {
+      xTaskCreatePinnedToCore(netTask, "frog net", FROG_NET_STACK, nullptr, FROG_NET_PRIORITY, &_netTask,
+                              FROG_NET_CORE);
+      Serial.printf("[INIT] Uplink on core %d, sensors on core %d\n", FROG_NET_CORE, xPortGetCoreID());
+    }
+#endif
+  }
+
+  void run() { _scheduler.run(); }
+
+  // --- For the sketch's display code ---
+  const char* name(uint8_t i) const { return _names[i]; }
+  float latest(uint8_t i, FrogChannel c) const { return _samples[i].latest(c); }
+  bool lastPostOk() const { return _lastCode == 200; }
+  FrogScheduler& scheduler() { return _scheduler; }
+  FrogUplink& uplink() { return _uplink; }
+
+  // Every sensor and each channel it has: the name, then two channels per
+  // line. Meant for a small text display or the serial console.
+  void printSummary(Print& out) const {
+    static const char* const kLabels[CH_COUNT] = {"T", "H", "Lux", "TDS", "Water"};
+    static const char* const kUnits[CH_COUNT] = {"F", "%", "", " ppm", "%"};
+    for (uint8_t i = 0; i < kCount; i++) {
+      out.printf("%s:\n", _names[i]);
+      uint8_t onLine = 0;
+      for (uint8_t c = 0; c < CH_COUNT; c++) {
+        float v = _samples[i].latest((FrogChannel)c);
+        if (isnan(v)) continue;
+        out.printf("%s%s: %.1f%s", onLine ? " " : "", kLabels[c], v, kUnits[c]);
+        if (++onLine == 2) {
+          out.print("\n");
+          onLine = 0;
+        }
+      }
+      if (onLine) out.print("\n");
+    }
+  }
+
+private:
+  static constexpr bool allHaveIds() {
+    for (uint8_t i = 0; i < kCount; i++) {
+      if (frogSensorId(Sensors[i].name) == 0) return false;
+    }
+    return true;
+  }
+
+  static constexpr bool hasDht() {
+    for (uint8_t i = 0; i < kCount; i++) {
+      if (Sensors[i].hasDht()) return true;
+    }
+    return false;
+  }
+
+  // What begin() adds to the sensor scheduler. The sketch may add its own
+  // (a display), which add() reports at run time if there is no room.
+  static constexpr uint8_t sensorTasks() {
+    uint8_t n = hasDht() ? 2 : 0;
+    for (uint8_t i = 0; i < kCount; i++) n += Sensors[i].hasFast() + Sensors[i].hasLevel();
+    if (Config.sleepBetweenReports) return n + 1;
+    return n + (kPipelined ? 2 : 4);
+  }
+
+  static constexpr bool needsI2c() {
+    if (Config.sda >= 0) return true;
+    for (uint8_t i = 0; i < kCount; i++) {
+      if (Sensors[i].hasLux()) return true;
+    }
+    return false;
+  }
+
+  template <size_t... Is>
+  static auto makeSlots(std::index_sequence<Is...>) -> std::tuple<FrogSensorSlot<Sensors, Is>...>;
+  using Slots = decltype(makeSlots(std::make_index_sequence<kCount>{}));
+
+  template <size_t... Is>
+  void beginSlots(std::index_sequence<Is...>) {
+    (beginSlot<Is>(), ...);
+  }
+
+  // Sensors are staggered by 300 ms so their reads do not share a pass.
+  template <size_t I>
+  void beginSlot() {
+    constexpr FrogSensorSpec S = Sensors[I];
+    std::get<I>(_slots).begin();
+    if constexpr (S.hasFast()) _scheduler.add(S.name, FROG_FAST_MS, 200, fastTask<I>, I, I * 300);
+    if constexpr (S.hasLevel()) _scheduler.add(S.name, FROG_SONAR_GAP_MS, 20, sonarTask<I>, I, I * 300 + 10);
+  }
+
+  // --- Tasks ---
+
+  static void dhtTask(uint8_t) {
+    _self->startDhts(std::make_index_sequence<kCount>{});
+  }
+
+  static void dhtPollTask(uint8_t) {
+    _self->pollDhts(std::make_index_sequence<kCount>{});
+  }
+
+  template <size_t... Is>
+  void startDhts(std::index_sequence<Is...>) {
+    (std::get<Is>(_slots).startDht(), ...);
+  }
+
+  template <size_t... Is>
+  void pollDhts(std::index_sequence<Is...>) {
+    (std::get<Is>(_slots).pollDht(_samples[Is]), ...);
+  }
+
+  template <size_t I>
+  static void fastTask(uint8_t) {
+    std::get<I>(_self->_slots).sampleFast(_self->_samples[I]);
+  }
+
+  template <size_t I>
+  static void sonarTask(uint8_t) {
+    std::get<I>(_self->_slots).sampleSonar(_self->_samples[I]);
+  }
+
+  // Every sensor's mean since the last report goes out in one batch, in
+  // the node's configured payload format (FROG_JSON, FROG_PACKED or FROG_CBOR)
+  static void reportTask(uint8_t) {
+    _self->report();
+  }
+
+  // Hand the cycle's readings to the network side. While the queue has no
+  // room for a whole report the samples keep averaging into the next one,
+  // up to FROG_PIPE_MAX_DEFER reports; after that what does not fit is
+  // dropped.
+  void report() {
+    if (_queue.space() < kCount && _deferrals < FROG_PIPE_MAX_DEFER) {
+      _deferrals++;
+      _pipe.deferred++;
+      Serial.printf("[PIPE] Uplink behind, report deferred (%u)\n", _deferrals);
+      return;
+    }
+    _deferrals = 0;
+    FrogReading readings[kCount];
+    Unsent unsent[kCount];
+    uint8_t count = collect(readings, unsent);
+    bool rolledBack = false;
+    for (uint8_t i = 0; i < count; i++) {
+      if (_queue.push(readings[i])) {
+        _pipe.queued++;
+      } else {
+        // Not sent after all, so the next report must not hold these
+        // channels back as unchanged
+        _rtc.sent(unsent[i].sensor) = unsent[i].sent;
+        rolledBack = true;
+        _pipe.dropped++;
+      }
+    }
+    if (rolledBack) _rtc.save();
+#if FROG_DUAL_CORE
+    if constexpr (kPipelined) {
+      if (count) xTaskNotifyGive(_netTask);
+      return;
+    }
+#endif
+    sendQueued();
+  }
+
+  // Network side: one POST per report. Kept on the node if Wi-Fi or the
+  // server is down.
+  void sendQueued() {
+    FrogReading batch[kCount];
+    uint8_t n;
+    while ((n = _queue.pop(batch, kCount)) > 0) {
+      _pipe.sent += n;
+      int code = frogSendOrSpool(_uplink, _spool, batch, n);
+      if (code != FROG_SEND_DEFERRED) _lastCode = code;
+    }
+  }
+
+  FrogScheduler& netScheduler() {
+    if constexpr (kPipelined) {
+      return _netScheduler;
+    } else {
+      return _scheduler;
+    }
+  }
+
+#if FROG_DUAL_CORE
+  // Pinned to FROG_NET_CORE. Sleeps until a report is queued or the next
+  // network task is due.
+  static void netTask(void*) {
+    FrogNode& n = *_self;
+    for (;;) {
+      n.sendQueued();
+      n._netScheduler.run();
+      uint32_t idle = n._netScheduler.idleMs();
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idle < 1000 ? idle : 1000));
+    }
+  }
+#endif
+
+  // A sensor's deadband state from before collect() marked a reading sent
+  struct Unsent {
+    uint8_t sensor;
+    FrogSent sent;
+  };
+
+  // Take every sensor's mean since the last report and drop the channels
+  // still inside their deadband. Returns how many readings have anything
+  // left to send. If unsent is given, it gets each reading's deadband
+  // state from before, for putting back if the reading goes nowhere.
+  uint8_t collect(FrogReading* readings, Unsent* unsent = nullptr) {
+    uint8_t count = 0;
+    bool sampled = false;
+    uint32_t now = frogNow();
+    uint32_t clock = _rtc.clockS();
+
+    for (uint8_t i = 0; i < kCount; i++) {
+      FrogReading& r = readings[count];
+      r = FrogReading(_names[i]);
+      r.id = _ids[i];
+      r.ts = now;
+      if (!_samples[i].take(r)) continue;
+      sampled = true;
+      if constexpr (Config.sleepBetweenReports) _rtc.track(i, r, Sensors[i].limit);
+      if (unsent) unsent[count] = {i, _rtc.sent(i)};
+      if (!frogDeadband(r, _rtc.sent(i), Sensors[i].deadbands, clock, FROG_HEARTBEAT_S)) {
+        _heldCount++;
+        continue;
+      }
+      r.seq = _rtc.nextSeq();
+      _sentCount++;
+      count++;
+    }
+    _rtc.save();
+
+    if (!sampled) {
+      Serial.println("[WARN] No readings this cycle.");
+      _lastCode = -1;
+    }
+    return count;
+  }
+
+  // Deep-sleep mode: the whole wake is this one task. Sample for
+  // FROG_AWAKE_MS, then report once and sleep. A node that has never
+  // known the time first waits for SNTP; after that RTC memory carries the
+  // clock from one wake to the next. If nothing moved past its deadband
+  // and the spool is empty, the node sleeps again without waiting for
+  // Wi-Fi. Otherwise it waits up to FROG_WIFI_TIMEOUT_MS, and the readings
+  // are spooled if Wi-Fi never comes.
+  static void cycleTask(uint8_t) {
+    FrogNode& n = *_self;
+    unsigned long awake = millis();
+    bool online = WiFi.status() == WL_CONNECTED;
+    bool timedOut = awake >= FROG_WIFI_TIMEOUT_MS;
+    if (!online && n._rtc.joiningFast() && awake >= FROG_FAST_JOIN_MS) {
+      Serial.println("[WIFI] Saved AP did not answer, scanning...");
+      n._rtc.rescan(Config.ssid, Config.password);
+    }
+    if (awake - n._awakeSince < FROG_AWAKE_MS) return;
+    if (frogNow() == 0 && !timedOut) return;
+
+    if (n._pendingCount < 0) n._pendingCount = n.collect(n._pending);
+    bool idle = n._pendingCount == 0 && n._spool.size() == 0;
+    if (!idle && !online && !timedOut) return;
+
+    if (online) {
+      Serial.printf("[WIFI] Connected: %s\n", WiFi.localIP().toString().c_str());
+      n._rtc.rememberAp(Config.ssid);
+    }
+    if (n._pendingCount > 0) {
+      int code = frogSendOrSpool(n._uplink, n._spool, n._pending, n._pendingCount);
+      if (code != FROG_SEND_DEFERRED) n._lastCode = code;
+    } else if (online) {
+      n._spool.drain(n._uplink);
+    }
+    n._rtc.sleep(n._rtc.plan());
+  }
+
+  static void drainTask(uint8_t) {
+    _self->_spool.drain(_self->_uplink);
+  }
+
+  static void statsTask(uint8_t) {
+    Serial.printf("[BATCH] readings sent=%lu held=%lu (deadband) overflow=%lu (spooled)\n",
+                  (unsigned long)_self->_sentCount, (unsigned long)_self->_heldCount,
+                  (unsigned long)_self->_spool.overflowed());
+    _self->printSlotStats(std::make_index_sequence<kCount>{});
+    _self->_uplink.printStats(Serial);
+    const FrogPipeStats& p = _self->_pipe;
+    Serial.printf("[PIPE] queued=%lu sent=%lu deferred=%lu dropped=%lu high-water=%u/%u (%s)\n",
+                  (unsigned long)p.queued, (unsigned long)p.sent, (unsigned long)p.deferred,
+                  (unsigned long)p.dropped, _self->_queue.highWater(), FROG_PIPE_DEPTH,
+                  kPipelined ? "uplink on its own core" : "single core");
+    _self->_scheduler.printStats(Serial);
+    if constexpr (kPipelined) {
+      Serial.println("[SCHED] network core:");
+      _self->_netScheduler.printStats(Serial);
+    }
+  }
+
+  template <size_t... Is>
+  void printSlotStats(std::index_sequence<Is...>) {
+    (std::get<Is>(_slots).printStats(Serial), ...);
+  }
+
+  // Readings are spooled while offline, so keep retrying instead of
+  // rebooting. Each attempt gets FROG_WIFI_TIMEOUT_MS before a restart.
+  static void wifiTask(uint8_t) {
+    FrogNode& n = *_self;
+    if (WiFi.status() == WL_CONNECTED) {
+      if (n._wifiDisconnectedSince != 0 || n._wifiAttemptStart != 0) {
+        Serial.printf("[WIFI] Connected: %s\n", WiFi.localIP().toString().c_str());
+      }
+      n._wifiDisconnectedSince = 0;
+      n._wifiAttemptStart = 0;
+      return;
+    }
+    if (n._wifiDisconnectedSince == 0) n._wifiDisconnectedSince = millis();
+    if (n._wifiAttemptStart == 0 || millis() - n._wifiAttemptStart >= FROG_WIFI_TIMEOUT_MS) {
+      Serial.printf("[WIFI] Offline for %lus, reconnecting...\n", (millis() - n._wifiDisconnectedSince) / 1000);
+      WiFi.disconnect();
+      WiFi.begin(Config.ssid, Config.password);
+      n._wifiAttemptStart = millis();
+    }
+  }
+
+  static inline FrogNode* _self = nullptr;
+
+  Slots _slots;
+  FrogAverage _samples[kCount];
+  const char* _names[kCount];
+  uint8_t _ids[kCount];  // wire IDs, for the binary payloads
+  FrogScheduler _scheduler;
+  FrogUplink _uplink;
+  FrogSpool _spool;
+  FrogRtc _rtc;
+  FrogReadingQueue _queue;
+  FrogPipeStats _pipe;
+  uint8_t _deferrals = 0;  // reports deferred in a row
+  FrogPart<FrogScheduler, kPipelined> _netScheduler;  // wifi and spool, on the network core
+#if FROG_DUAL_CORE
+  TaskHandle_t _netTask = nullptr;
+#endif
+  std::atomic<int> _lastCode{-1};  // written by the network side, read by the display
+  unsigned long _wifiDisconnectedSince = 0;
+  unsigned long _wifiAttemptStart = 0;
+  unsigned long _awakeSince = 0;  // deep-sleep mode: sampling started
+  FrogReading _pending[kCount];   // deep-sleep mode: this wake's readings
+  int8_t _pendingCount = -1;      // -1 = not collected yet
+  uint32_t _sentCount = 0;
+  uint32_t _heldCount = 0;
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+// --- FrogPack ---
+// Binary /api/sensor payloads. JSON repeats every sensor name and key and
+// prints every number as text: ~100 bytes a reading. Two
+// binary formats carry the same readings, picked per node with
+// FrogNodeConfig{...}.payload(FROG_PACKED):
+//
+//   FROG_PACKED  application/x-frogpack, ~15 bytes a reading
+//
+//     batch   'F' version count:u8 record*count
+//     record  id:u8 mask:u8 ts:u32le seq:varint value:zigzag-varint*
+//
+//     id is the sensor's wire ID (kFrogSensorIds). Bit c of mask says
+//     channel c is present; the values follow in channel order, each the
+//     reading times 10^decimals (kFrogFields), so they keep exactly the
+//     precision the JSON text had. ts 0 = not set, seq 0 = not numbered.
+//
+//   FROG_CBOR    application/cbor (RFC 8949), ~35 bytes a reading, for
+//                clients that would rather use a stock decoder
+//
+//     an indefinite-length array of maps {0: id, 1: ts, 2: seq, 10+c: value}
+//     with each value a decimal fraction (tag 4, [-decimals, mantissa])
+//
+// frogApiApp/frogpack.py decodes both. Like FrogJsonWriter everything is
+// written straight into a caller's buffer, and a reading that does not fit
+// is dropped whole.
+
+#include <FrogReading.h>
+#include <FrogJson.h>
+#include <new>
+#include <string.h>
+
+#define FROG_PACK_VERSION 1
+#define FROG_PACK_MAGIC 'F'
+
+enum FrogFormat : uint8_t { FROG_JSON, FROG_PACKED, FROG_CBOR };
+
+// --- Sensor wire IDs ---
+// Same table as `sensor_ids` in app.py. IDs are never reused; a renamed
+// sensor gets a new one. The name is exactly what the node sends in JSON.
+struct FrogSensorId {
+  uint8_t id;
+  const char* name;
+};
+
+constexpr FrogSensorId kFrogSensorIds[] = {
+  {1, "Whites Tree Frog Terrarium"},
+  {2, "Green Tree Frog Terrarium"},
+  {3, "Office Sensor"},
+  {4, "Other Sensor"},
+  {5, "Red Knee"},
+  {6, "Avicularia Avicularia"},
+  {7, "Living Room"},
+  {8, "Bedroom"},
+  {9, "3D Printer"},
+  {10, "White Tree Frog Terrarium"},
+  {11, "Green Tree Frog"},
+  {12, "Plant Tank"},
+  {13, "Aquarium"},
+};
+
+constexpr bool frogSameName(const char* a, const char* b) {
+  while (*a && *a == *b) {
+    a++;
+    b++;
+  }
+  return *a == *b;
+}
+
+// 0 when the name has no ID yet.
+constexpr uint8_t frogSensorId(const char* name) {
+  for (const FrogSensorId& s : kFrogSensorIds) {
+    if (frogSameName(s.name, name)) return s.id;
+  }
+  return 0;
+}
+
+// --- Writer ---
+class FrogPackWriter {
+public:
+  FrogPackWriter(uint8_t* buf, size_t cap, bool cbor) : _buf(buf), _cap(cap), _cbor(cbor) { reset(); }
+
+  void reset() {
+    _len = 0;
+    _count = 0;
+    _overflow = false;
+    _closed = false;
+    if (_cbor) {
+      put(0x9F);  // array of indefinite length
+    } else {
+      put(FROG_PACK_MAGIC);
+      put(FROG_PACK_VERSION);
+      put(0);  // count, set by finish()
+    }
+  }
+
+  bool add(const FrogReading& r) {
+    if (_closed || _count == 255) return false;
+    size_t mark = _len;
+    bool fits = _cbor ? addCbor(r) : addPacked(r);
+    // Keep one byte for the CBOR break.
+    if (!fits || _len + 1 > _cap) {
+      _len = mark;
+      _overflow = true;
+      return false;
+    }
+    _count++;
+    return true;
+  }
+
+  const uint8_t* finish() {
+    if (!_closed) {
+      if (_cbor) {
+        _buf[_len++] = 0xFF;  // break
+      } else {
+        _buf[2] = (uint8_t)_count;
+      }
+      _closed = true;
+    }
+    return _buf;
+  }
+
+  const uint8_t* data() const { return _buf; }
+  size_t length() const { return _len; }
+  uint16_t count() const { return _count; }
+  bool overflowed() const { return _overflow; }
+
+private:
+  // The value as the integer JSON would have printed, rounded the same way.
+  // False for values JSON would have sent as null.
+  static bool fixed(float v, uint8_t decimals, int32_t& out) {
+    static const float kScale[] = {1, 10, 100, 1000, 10000};
+    if (decimals > 4) decimals = 4;
+    if (isnan(v) || isinf(v) || fabsf(v) * kScale[decimals] > 2e9f) return false;
+    int32_t m = (int32_t)(fabsf(v) * kScale[decimals] + 0.5f);
+    out = v < 0 ? -m : m;
+    return true;
+  }
+
+  bool addPacked(const FrogReading& r) {
+    int32_t values[CH_COUNT];
+    uint8_t mask = 0;
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      if (fixed(r.value[c], kFrogFields[c].decimals, values[c])) mask |= 1 << c;
+    }
+    bool fits = put(r.id) && put(mask);
+    for (uint8_t i = 0; i < 4; i++) fits = fits && put((uint8_t)(r.ts >> (8 * i)));
+    fits = fits && putVarint(r.seq);
+    for (uint8_t c = 0; c < CH_COUNT && fits; c++) {
+      if (mask & (1 << c)) fits = putVarint(((uint32_t)values[c] << 1) ^ (uint32_t)(values[c] >> 31));
+    }
+    return fits;
+  }
+
+  bool addCbor(const FrogReading& r) {
+    int32_t values[CH_COUNT];
+    uint8_t pairs = 1 + (r.ts != 0) + (r.seq != 0);
+    bool present[CH_COUNT];
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      present[c] = fixed(r.value[c], kFrogFields[c].decimals, values[c]);
+      pairs += present[c];
+    }
+    bool fits = putCbor(5, pairs) && putCbor(0, 0) && putCbor(0, r.id);
+    if (r.ts) fits = fits && putCbor(0, 1) && putCbor(0, r.ts);
+    if (r.seq) fits = fits && putCbor(0, 2) && putCbor(0, r.seq);
+    for (uint8_t c = 0; c < CH_COUNT && fits; c++) {
+      if (!present[c]) continue;
+      uint8_t decimals = kFrogFields[c].decimals;
+      fits = putCbor(0, 10 + c);
+      if (decimals) fits = fits && put(0xC4) && put(0x82) && putCbor(1, decimals - 1);  // tag 4 [-decimals,
+      fits = fits && putCborInt(values[c]);                                               //        mantissa]
+    }
+    return fits;
+  }
+
+  bool put(uint8_t b) {
+    if (_len + 1 > _cap) return false;
+    _buf[_len++] = b;
+    return true;
+  }
+
+  bool putVarint(uint32_t v) {
+    while (v >= 0x80) {
+      if (!put((uint8_t)(v | 0x80))) return false;
+      v >>= 7;
+    }
+    return put((uint8_t)v);
+  }
+
+  // CBOR head: major type and argument, shortest form.
+  bool putCbor(uint8_t major, uint32_t v) {
+    uint8_t m = major << 5;
+    if (v < 24) return put(m | v);
+    if (v <= 0xFF) return put(m | 24) && put((uint8_t)v);
+    if (v <= 0xFFFF) return put(m | 25) && put((uint8_t)(v >> 8)) && put((uint8_t)v);
+    return put(m | 26) && put((uint8_t)(v >> 24)) && put((uint8_t)(v >> 16)) && put((uint8_t)(v >> 8)) &&
+           put((uint8_t)v);
+  }
+
+  bool putCborInt(int32_t v) {
+    return v < 0 ? putCbor(1, (uint32_t)(-(v + 1))) : putCbor(0, (uint32_t)v);
+  }
+
+  uint8_t* _buf;
+  size_t _cap;
+  bool _cbor;
+  size_t _len = 0;
+  uint16_t _count = 0;
+  bool _overflow = false;
+  bool _closed = false;
+};
+
+// --- FrogBatch ---
+// One POST body in the node's format: a FrogJsonWriter or a FrogPackWriter
+// over the same buffer.
+class FrogBatch {
+public:
+  FrogBatch(FrogFormat format, uint8_t* buf, size_t cap) : _format(format) {
+    if (format == FROG_JSON) {
+      new (&_json) FrogJsonWriter((char*)buf, cap);
+    } else {
+      new (&_pack) FrogPackWriter(buf, cap, format == FROG_CBOR);
+    }
+  }
+
+  bool add(const FrogReading& r) { return _format == FROG_JSON ? _json.add(r) : _pack.add(r); }
+
+  void finish() {
+    if (_format == FROG_JSON) {
+      _json.finish();
+    } else {
+      _pack.finish();
+    }
+  }
+
+  const uint8_t* data() const {
+    return _format == FROG_JSON ? (const uint8_t*)_json.c_str() : _pack.data();
+  }
+  size_t length() const { return _format == FROG_JSON ? _json.length() : _pack.length(); }
+  uint16_t count() const { return _format == FROG_JSON ? _json.count() : _pack.count(); }
+  FrogFormat format() const { return _format; }
+
+  const char* contentType() const {
+    switch (_format) {
+      case FROG_PACKED: return "application/x-frogpack";
+      case FROG_CBOR: return "application/cbor";
+      default: return "application/json";
+    }
+  }
+
+private:
+  FrogFormat _format;
+  union {
+    FrogJsonWriter _json;
+    FrogPackWriter _pack;
+  };
+};
+
+// A batch that owns its storage, meant to live on the stack.
+template <size_t N>
+class FrogBatchBuffer : public FrogBatch {
+public:
+  explicit FrogBatchBuffer(FrogFormat format) : FrogBatch(format, _storage, N) {}
+
+private:
+  uint8_t _storage[N];
+};
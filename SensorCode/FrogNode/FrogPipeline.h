@@ -0,0 +1,102 @@
+#pragma once
+
+// --- FrogPipeline ---
+// Sensing and networking on separate cores. With everything in loop(), a
+// TLS POST to a slow server held up the sensor reads and the display for
+// as long as the server took to answer.
+//
+// On a dual-core ESP32 a node built with FrogNodeConfig{...}.dualCore()
+// splits in two:
+//
+//   core 1  loop(): sensors, display, and the report task, which takes the
+//           cycle's readings and pushes them into a FrogReadingQueue
+//   core 0  the network task (next to the Wi-Fi stack): pops readings and
+//           POSTs them, drains the spool, keeps Wi-Fi up
+//
+// The queue is single-producer/single-consumer and lock-free: each side
+// only writes its own index. When the network side falls behind and the
+// queue has no room for a whole report, the report is deferred and the
+// sensors keep averaging into the next one (backpressure). After
+// FROG_PIPE_MAX_DEFER deferrals in a row the report goes ahead and what
+// does not fit is dropped. Both are counted in the [PIPE] stats line.
+//
+// On a single-core chip (ESP32-S2/C3/C6, ESP8266) the same queue is used,
+// but the report task sends it straight away from loop(), as before.
+
+#include <Arduino.h>
+#include <atomic>
+#include <FrogReading.h>
+#if !defined(ESP8266)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#if defined(ESP8266) || CONFIG_FREERTOS_UNICORE
+#define FROG_DUAL_CORE 0
+#else
+#define FROG_DUAL_CORE 1
+#endif
+
+#ifndef FROG_PIPE_DEPTH
+#define FROG_PIPE_DEPTH 16  // readings; a power of two
+#endif
+#ifndef FROG_PIPE_MAX_DEFER
+#define FROG_PIPE_MAX_DEFER 3
+#endif
+#ifndef FROG_NET_CORE
+#define FROG_NET_CORE 0
+#endif
+#ifndef FROG_NET_STACK
+#define FROG_NET_STACK 8192  // TLS needs most of it
+#endif
+#ifndef FROG_NET_PRIORITY
+#define FROG_NET_PRIORITY 1
+#endif
+
+static_assert((FROG_PIPE_DEPTH & (FROG_PIPE_DEPTH - 1)) == 0, "FROG_PIPE_DEPTH must be a power of two");
+
+// Each counter has one writer: the report task, or the network side for
+// `sent`.
+struct FrogPipeStats {
+  uint32_t queued = 0;    // readings pushed
+  uint32_t sent = 0;      // readings popped by the network side
+  uint32_t deferred = 0;  // reports put off because the queue was full
+  uint32_t dropped = 0;   // readings that did not fit after FROG_PIPE_MAX_DEFER
+};
+
+class FrogReadingQueue {
+public:
+  // Producer side.
+  uint16_t space() const {
+    return FROG_PIPE_DEPTH - (uint16_t)(_head.load(std::memory_order_relaxed) -
+                                        _tail.load(std::memory_order_acquire));
+  }
+
+  bool push(const FrogReading& r) {
+    uint16_t head = _head.load(std::memory_order_relaxed);
+    uint16_t used = (uint16_t)(head - _tail.load(std::memory_order_acquire));
+    if (used == FROG_PIPE_DEPTH) return false;
+    _slots[head & (FROG_PIPE_DEPTH - 1)] = r;
+    _head.store(head + 1, std::memory_order_release);
+    if (used + 1 > _highWater) _highWater = used + 1;
+    return true;
+  }
+
+  // Consumer side. Copies out up to max readings, oldest first.
+  uint8_t pop(FrogReading* out, uint8_t max) {
+    uint16_t tail = _tail.load(std::memory_order_relaxed);
+    uint16_t avail = (uint16_t)(_head.load(std::memory_order_acquire) - tail);
+    uint8_t n = avail < max ? avail : max;
+    for (uint8_t i = 0; i < n; i++) out[i] = _slots[(tail + i) & (FROG_PIPE_DEPTH - 1)];
+    _tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  uint16_t highWater() const { return _highWater; }
+
+private:
+  FrogReading _slots[FROG_PIPE_DEPTH];
+  std::atomic<uint16_t> _head{0};  // written by the producer only
+  std::atomic<uint16_t> _tail{0};  // written by the consumer only
+  uint16_t _highWater = 0;         // producer side
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+// --- FrogReading ---
+// One sensor's values from one cycle. The channel list is fixed at compile
+// time; a channel that a sensor does not have is left as NAN and is simply
+// not sent. Plain C++ on purpose so host tools can include it.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+enum FrogChannel : uint8_t {
+  CH_TEMP,         // °F
+  CH_HUMIDITY,     // %
+  CH_LUX,          // lx
+  CH_TDS,          // ppm
+  CH_WATER_LEVEL,  // % full
+  CH_COUNT
+};
+
+struct FrogField {
+  const char* key;   // JSON key the Frog API expects
+  uint8_t decimals;  // digits after the point when sent as text
+  float noise;       // changes up to this size are sensor noise, not a trend
+  float deadband;    // default: not sent again until it moves this far
+};
+
+// DHT11 steps are 1 °C (1.8 °F) and 1 %, so one step either way is noise.
+// The deadbands are smaller so a real one-step change is still reported.
+constexpr FrogField kFrogFields[CH_COUNT] = {
+  {"temp", 1, 2.0f, 1.0f},
+  {"humidity", 1, 2.0f, 1.5f},
+  {"lux", 1, 20.0f, 10.0f},
+  {"tds", 1, 10.0f, 5.0f},
+  {"water_level", 1, 2.0f, 1.0f},
+};
+
+// Safe range for one channel, as in the server's `thresholds` table.
+struct FrogLimit {
+  float lo = 0;
+  float hi = 0;
+
+  constexpr bool set() const { return hi > lo; }
+};
+
+struct FrogReading {
+  const char* sensor = "unknown";
+  uint32_t ts = 0;   // device epoch seconds; 0 = clock not set, server stamps it
+  uint32_t seq = 0;  // per-node reading counter; 0 = not numbered
+  uint8_t id = 0;    // wire ID for the binary formats (FrogPack.h); 0 = none
+  float value[CH_COUNT];
+
+  FrogReading() { clear(); }
+  explicit FrogReading(const char* name) : sensor(name) { clear(); }
+
+  void clear() {
+    for (uint8_t c = 0; c < CH_COUNT; c++) value[c] = NAN;
+  }
+
+  FrogReading& set(FrogChannel c, float v) {
+    value[c] = v;
+    return *this;
+  }
+
+  bool has(FrogChannel c) const { return !isnan(value[c]); }
+};
+
+// --- Deadband ---
+// What one sensor last sent. A channel that has not moved past its
+// deadband since then is left out of the next reading; the server carries
+// its previous value forward. Every channel goes out again once
+// the heartbeat is due, so a quiet sensor still shows up as alive.
+struct FrogSent {
+  float value[CH_COUNT];  // NAN = never sent
+  uint32_t atS;           // node clock (seconds) of the last heartbeat
+};
+
+// Strip the unchanged channels from r and record what is left as sent.
+// Returns false when nothing is left to send.
+inline bool frogDeadband(FrogReading& r, FrogSent& sent, const float* deadband,
+                         uint32_t nowS, uint32_t heartbeatS) {
+  bool beat = nowS - sent.atS >= heartbeatS;  // also true after the clock restarted
+  bool any = false;
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    if (!r.has((FrogChannel)c)) continue;
+    if (!beat && !isnan(sent.value[c]) && fabsf(r.value[c] - sent.value[c]) < deadband[c]) {
+      r.value[c] = NAN;
+      continue;
+    }
+    sent.value[c] = r.value[c];
+    any = true;
+  }
+  if (beat && any) sent.atS = nowS;
+  return any;
+}
+
+// FNV-1a over a node's sensor names. Anything stored by sensor index (the
+// spool, RTC state) is tagged with it, so a reflash that renames or
+// reorders sensors does not relabel old data.
+inline uint32_t frogTableHash(const char* const* names, uint8_t count) {
+  uint32_t h = 2166136261UL;
+  for (uint8_t i = 0; i < count; i++) {
+    for (const char* p = names[i]; *p; p++) h = (h ^ (uint8_t)*p) * 16777619UL;
+    h = (h ^ 0xFF) * 16777619UL;
+  }
+  return h;
+}
+
+// --- FrogAverage ---
+// Sensors can be sampled faster than the node reports. Each sample is
+// folded into a running sum per channel; take() hands back the mean of
+// everything since the previous report and starts over. NAN samples
+// (failed reads) are ignored.
+struct FrogAverage {
+  float sum[CH_COUNT];
+  uint16_t n[CH_COUNT];
+  float last[CH_COUNT];
+
+  FrogAverage() {
+    reset();
+    for (uint8_t c = 0; c < CH_COUNT; c++) last[c] = NAN;
+  }
+
+  void reset() {
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      sum[c] = 0;
+      n[c] = 0;
+    }
+  }
+
+  void add(FrogChannel c, float v) {
+    if (isnan(v)) return;
+    sum[c] += v;
+    n[c]++;
+    last[c] = v;
+  }
+
+  // Most recent sample, for the display.
+  float latest(FrogChannel c) const { return last[c]; }
+
+  // Fill the present channels of r with their means. Returns false when
+  // nothing was sampled since the last take().
+  bool take(FrogReading& r) {
+    bool any = false;
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      if (n[c] == 0) continue;
+      r.value[c] = sum[c] / n[c];
+      any = true;
+    }
+    reset();
+    return any;
+  }
+};
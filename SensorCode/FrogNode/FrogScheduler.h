@@ -0,0 +1,139 @@
+#pragma once
+
+// --- FrogScheduler ---
+// A small cooperative scheduler for loop(). Each job (a sensor, the uplink,
+// the display, Wi-Fi upkeep) is a task with its own period and deadline.
+// Tasks must not block; loop() just calls scheduler.run().
+//
+// Every period a task is "released". The scheduler runs the released task
+// with the earliest absolute deadline (release + deadline) first, and
+// keeps per-task counters:
+//   jitter   - how late the task started after its release
+//   run      - how long the task body took
+//   overrun  - finished later than release + deadline
+//   skipped  - whole periods that went by without the task running (it
+//              fell so far behind that those releases were dropped)
+
+#include <Arduino.h>
+
+#ifndef FROG_MAX_TASKS
+#define FROG_MAX_TASKS 16
+#endif
+
+typedef void (*FrogTaskFn)(uint8_t arg);
+
+struct FrogTask {
+  const char* name;
+  FrogTaskFn fn;
+  uint8_t arg;
+  bool enabled;
+  uint32_t periodMs;
+  uint32_t deadlineMs;
+  uint32_t release;  // millis() of the next release
+
+  uint32_t runs;
+  uint32_t overruns;
+  uint32_t skipped;
+  uint32_t jitterMax;
+  uint32_t jitterSum;
+  uint32_t runMax;
+};
+
+class FrogScheduler {
+public:
+  // offsetMs staggers tasks that share a period so they do not all fire in
+  // the same loop() pass.
+  FrogTask* add(const char* name, uint32_t periodMs, uint32_t deadlineMs, FrogTaskFn fn,
+                uint8_t arg = 0, uint32_t offsetMs = 0) {
+    if (_count >= FROG_MAX_TASKS) {
+      Serial.printf("[ERROR] Scheduler full (FROG_MAX_TASKS %d), task '%s' will never run!\n", FROG_MAX_TASKS, name);
+      return nullptr;
+    }
+    FrogTask& t = _tasks[_count++];
+    t = FrogTask{};
+    t.name = name;
+    t.fn = fn;
+    t.arg = arg;
+    t.enabled = true;
+    t.periodMs = periodMs;
+    t.deadlineMs = deadlineMs;
+    t.release = millis() + offsetMs;
+    return &t;
+  }
+
+  // Run every task that is due, earliest deadline first. Call from loop().
+  void run() {
+    while (runOnce()) {
+    }
+  }
+
+  // Run the most urgent due task. Returns false when nothing is due.
+  bool runOnce() {
+    uint32_t now = millis();
+    FrogTask* next = nullptr;
+    for (uint8_t i = 0; i < _count; i++) {
+      FrogTask& t = _tasks[i];
+      if (!t.enabled || (int32_t)(now - t.release) < 0) continue;
+      if (!next || (int32_t)((t.release + t.deadlineMs) - (next->release + next->deadlineMs)) < 0) next = &t;
+    }
+    if (!next) return false;
+    execute(*next, now);
+    return true;
+  }
+
+  // Release a task right away (e.g. redraw the display after a POST).
+  void trigger(FrogTask* t) {
+    if (t) t->release = millis();
+  }
+
+  // Milliseconds until the next release, for callers that want to idle.
+  uint32_t idleMs() const {
+    uint32_t now = millis();
+    uint32_t best = UINT32_MAX;
+    for (uint8_t i = 0; i < _count; i++) {
+      const FrogTask& t = _tasks[i];
+      if (!t.enabled) continue;
+      int32_t wait = (int32_t)(t.release - now);
+      if (wait <= 0) return 0;
+      if ((uint32_t)wait < best) best = wait;
+    }
+    return best;
+  }
+
+  void printStats(Print& out) const {
+    out.printf("[SCHED] %-10s %6s %6s %6s %6s %5s %5s\n",
+               "task", "period", "runs", "jitAvg", "jitMax", "over", "skip");
+    for (uint8_t i = 0; i < _count; i++) {
+      const FrogTask& t = _tasks[i];
+      out.printf("[SCHED] %-10s %6lu %6lu %6lu %6lu %5lu %5lu  (run max %lums)\n",
+                 t.name, (unsigned long)t.periodMs, (unsigned long)t.runs,
+                 (unsigned long)(t.runs ? t.jitterSum / t.runs : 0), (unsigned long)t.jitterMax,
+                 (unsigned long)t.overruns, (unsigned long)t.skipped, (unsigned long)t.runMax);
+    }
+  }
+
+  uint8_t size() const { return _count; }
+  const FrogTask& task(uint8_t i) const { return _tasks[i]; }
+
+private:
+  void execute(FrogTask& t, uint32_t start) {
+    uint32_t jitter = start - t.release;
+    t.fn(t.arg);
+    uint32_t end = millis();
+
+    t.runs++;
+    t.jitterSum += jitter;
+    if (jitter > t.jitterMax) t.jitterMax = jitter;
+    if (end - start > t.runMax) t.runMax = end - start;
+    if (end - t.release > t.deadlineMs) t.overruns++;
+
+    // Next release stays on the period grid; releases already in the past
+    // are dropped and counted instead of being run back to back.
+    uint32_t behind = (end - t.release) / t.periodMs;
+    t.skipped += behind;
+    t.release += t.periodMs * (behind + 1);
+  }
+
+  FrogTask _tasks[FROG_MAX_TASKS];
+  uint8_t _count = 0;
+};
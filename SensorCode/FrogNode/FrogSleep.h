@@ -0,0 +1,256 @@
+#pragma once
+
+// --- FrogSleep ---
+// Deep-sleep duty cycling. A node built with FrogNodeConfig::deepSleep()
+// does not idle with Wi-Fi on between reports. It wakes, samples every
+// sensor for FROG_AWAKE_MS while Wi-Fi joins, sends (or spools) one batch,
+// and sleeps again. That saves power, and the DHT11s next to the board are
+// no longer warmed by it.
+//
+// RAM does not survive deep sleep, so whatever the next wake needs is kept
+// in RTC memory (FrogRtcState):
+//
+//   - the sequence number of the next reading
+//   - what each sensor last sent, for the deadband (FrogSent)
+//   - the access point's BSSID and channel, so Wi-Fi rejoins without a scan
+//   - the wall clock at wake-up, so readings get a timestamp before SNTP answers
+//   - each sensor's last reported values and how fast they are moving
+//
+//   ESP32    RTC slow memory (RTC_NOINIT_ATTR), like the spool.
+//   ESP8266  RTC user memory, after the 128 bytes the OTA bootloader uses.
+//            GPIO16 (D0) must be wired to RST or the board never wakes up.
+//
+// The wake interval adapts between FROG_SLEEP_MIN_MS and FROG_SLEEP_MAX_MS.
+// When no channel moves by more than its noise step (kFrogFields), the
+// interval grows by half. A channel with limits (FrogSensorSpec::limit,
+// the same numbers as `thresholds` in app.py) caps the interval so the node
+// wakes FROG_SLEEP_LOOKAHEAD times before the current trend would cross a
+// limit. Once a value is outside its limits the node reports at the minimum
+// interval.
+
+#include <Arduino.h>
+#include <FrogReading.h>
+#include <FrogClock.h>
+#if defined(ESP8266)
+#include <ESP8266WiFi.h>
+#else
+#include <WiFi.h>
+#include <esp_sleep.h>
+#endif
+
+#ifndef FROG_AWAKE_MS
+#define FROG_AWAKE_MS 2000  // sampling window after each wake
+#endif
+#ifndef FROG_FAST_JOIN_MS
+#define FROG_FAST_JOIN_MS 3000  // give up on the remembered AP after this
+#endif
+#ifndef FROG_SLEEP_MIN_MS
+#define FROG_SLEEP_MIN_MS 30000
+#endif
+#ifndef FROG_SLEEP_MAX_MS
+#define FROG_SLEEP_MAX_MS 300000  // the dashboards call a sensor offline after 10 min
+#endif
+#ifndef FROG_SLEEP_LOOKAHEAD
+#define FROG_SLEEP_LOOKAHEAD 4
+#endif
+#ifndef FROG_RTC_SENSORS
+#define FROG_RTC_SENSORS 5
+#endif
+
+#define FROG_RTC_MAGIC 0x46524F52UL  // "FROR"
+#define FROG_RTC_USER_OFFSET 32      // ESP8266: 4-byte blocks reserved for eboot
+
+struct FrogTrend {
+  float last[CH_COUNT];   // value in the previous report, NAN = none yet
+  float slope[CH_COUNT];  // smoothed change per minute
+};
+
+struct FrogRtcState {
+  uint32_t magic;
+  uint32_t check;
+  uint32_t tableHash;   // sensor name table the trends refer to
+  uint32_t seq;         // sequence number of the next reading
+  uint32_t boots;
+  uint32_t intervalMs;  // wake-to-wake time that led to this wake
+  uint32_t clockS;      // node time before this wake, awake and asleep
+  uint32_t wakeEpoch;   // wall clock at wake-up, 0 = unknown
+  uint32_t ssidHash;    // the AP below belongs to this SSID
+  uint8_t bssid[6];
+  uint8_t channel;      // 0 = no AP remembered
+  uint8_t reserved;
+  FrogTrend trend[FROG_RTC_SENSORS];
+  FrogSent sent[FROG_RTC_SENSORS];
+};
+
+static_assert(sizeof(FrogRtcState) % 4 == 0, "RTC user memory is written in 4-byte blocks");
+static_assert(sizeof(FrogRtcState) <= 512 - FROG_RTC_USER_OFFSET * 4, "FrogRtcState does not fit RTC user memory");
+
+#if !defined(ESP8266)
+RTC_NOINIT_ATTR static FrogRtcState frogRtcState;
+#endif
+
+class FrogRtc {
+public:
+  // Load the state the last sleep left behind, or start fresh after a power
+  // cut or a reflash with different sensors.
+  void begin(uint32_t tableHash) {
+#if defined(ESP8266)
+    if (!ESP.rtcUserMemoryRead(FROG_RTC_USER_OFFSET, (uint32_t*)&_state, sizeof(_state))) _state.magic = 0;
+#else
+    _state = frogRtcState;
+#endif
+    if (_state.magic != FROG_RTC_MAGIC || _state.check != stateCheck(_state) || _state.tableHash != tableHash) {
+      memset(&_state, 0, sizeof(_state));
+      _state.magic = FROG_RTC_MAGIC;
+      _state.tableHash = tableHash;
+      _state.seq = 1;
+      _state.intervalMs = FROG_SLEEP_MIN_MS;
+      for (uint8_t i = 0; i < FROG_RTC_SENSORS; i++) {
+        for (uint8_t c = 0; c < CH_COUNT; c++) {
+          _state.trend[i].last[c] = NAN;
+          _state.trend[i].slope[c] = NAN;
+          _state.sent[i].value[c] = NAN;
+        }
+      }
+    }
+    _state.boots++;
+    // Only valid straight after a deep sleep; a reset in between clears it.
+    frogClockBase = _state.wakeEpoch;
+    _state.wakeEpoch = 0;
+    save();
+  }
+
+  uint32_t nextSeq() { return _state.seq++; }
+  uint32_t boots() const { return _state.boots; }
+  uint32_t intervalMs() const { return _state.intervalMs; }
+  FrogSent& sent(uint8_t i) { return _state.sent[i]; }
+
+  // Seconds since the state was created, counting deep sleep. Goes back
+  // after a plain reset, which just makes the next heartbeat come early.
+  uint32_t clockS() const { return _state.clockS + millis() / 1000; }
+
+  // --- Wi-Fi ---
+
+  // Join the AP from the last wake directly (no scan) when there is one.
+  void beginWifi(const char* ssid, const char* password) {
+    WiFi.persistent(false);  // the SDK would otherwise write flash on every wake
+    WiFi.mode(WIFI_STA);
+    _fastJoin = _state.channel != 0 && _state.ssidHash == ssidHash(ssid);
+    if (_fastJoin) {
+      WiFi.begin(ssid, password, _state.channel, _state.bssid);
+    } else {
+      WiFi.begin(ssid, password);
+    }
+  }
+
+  bool joiningFast() const { return _fastJoin; }
+
+  // The remembered AP did not answer: forget it and scan.
+  void rescan(const char* ssid, const char* password) {
+    _fastJoin = false;
+    _state.channel = 0;
+    WiFi.disconnect();
+    WiFi.begin(ssid, password);
+  }
+
+  void rememberAp(const char* ssid) {
+    memcpy(_state.bssid, WiFi.BSSID(), sizeof(_state.bssid));
+    _state.channel = (uint8_t)WiFi.channel();
+    _state.ssidHash = ssidHash(ssid);
+  }
+
+  // --- Adaptive interval ---
+
+  // Fold sensor i's report into its trend and note how soon its limits
+  // want the next look.
+  void track(uint8_t i, const FrogReading& r, const FrogLimit* limits) {
+    if (i >= FROG_RTC_SENSORS) return;
+    FrogTrend& t = _state.trend[i];
+    float minutes = _state.intervalMs / 60000.0f;
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      if (!r.has((FrogChannel)c)) continue;
+      float v = r.value[c];
+      if (!isnan(t.last[c])) {
+        float delta = v - t.last[c];
+        bool moved = fabsf(delta) > kFrogFields[c].noise;
+        if (moved) _moving = true;
+        float rate = moved ? delta / minutes : 0;
+        t.slope[c] = isnan(t.slope[c]) ? rate : (t.slope[c] + rate) / 2;
+      }
+      t.last[c] = v;
+
+      const FrogLimit& limit = limits[c];
+      if (!limit.set()) continue;
+      if (v < limit.lo || v > limit.hi) {
+        cap(FROG_SLEEP_MIN_MS);
+        continue;
+      }
+      float slope = t.slope[c];
+      if (isnan(slope) || slope == 0) continue;
+      float room = slope > 0 ? limit.hi - v : v - limit.lo;
+      cap(room / fabsf(slope) * 60000.0f / FROG_SLEEP_LOOKAHEAD);
+    }
+  }
+
+  // Interval until the next wake, from what track() saw this cycle.
+  uint32_t plan() {
+    uint32_t next = _state.intervalMs;
+    if (!_moving) next += next / 2;
+    if (_capMs < next) next = (uint32_t)_capMs;
+    if (next < FROG_SLEEP_MIN_MS) next = FROG_SLEEP_MIN_MS;
+    if (next > FROG_SLEEP_MAX_MS) next = FROG_SLEEP_MAX_MS;
+    _state.intervalMs = next;
+    return next;
+  }
+
+  void save() {
+    _state.check = stateCheck(_state);
+#if defined(ESP8266)
+    ESP.rtcUserMemoryWrite(FROG_RTC_USER_OFFSET, (uint32_t*)&_state, sizeof(_state));
+#else
+    frogRtcState = _state;
+#endif
+  }
+
+  // Save the state and deep sleep until intervalMs after this wake began.
+  // Does not return; the next wake starts again at setup().
+  void sleep(uint32_t intervalMs) {
+    uint32_t awake = millis();
+    uint32_t sleepMs = intervalMs > awake + 1000 ? intervalMs - awake : 1000;
+    uint32_t now = frogNow();
+    _state.wakeEpoch = now ? now + (sleepMs + 500) / 1000 : 0;
+    _state.clockS += (awake + sleepMs + 500) / 1000;
+    save();
+    Serial.printf("[SLEEP] Awake %lums, next wake in %lus (boot %lu)\n", (unsigned long)awake,
+                  (unsigned long)(sleepMs / 1000), (unsigned long)_state.boots);
+    Serial.flush();
+    WiFi.disconnect(true);
+#if defined(ESP8266)
+    ESP.deepSleep((uint64_t)sleepMs * 1000ULL);
+#else
+    esp_deep_sleep((uint64_t)sleepMs * 1000ULL);
+#endif
+  }
+
+private:
+  void cap(float ms) {
+    if (ms < _capMs) _capMs = ms;
+  }
+
+  static uint32_t ssidHash(const char* ssid) {
+    const char* name = ssid;
+    return frogTableHash(&name, 1);
+  }
+
+  static uint32_t stateCheck(const FrogRtcState& s) {
+    const uint32_t* w = (const uint32_t*)&s;
+    uint32_t h = 0xA5A5A5A5UL;
+    for (size_t i = 2; i < sizeof(s) / 4; i++) h = (h ^ w[i]) * 16777619UL;  // after magic and check
+    return h ^ s.magic;
+  }
+
+  FrogRtcState _state = {};
+  bool _fastJoin = false;
+  bool _moving = false;
+  float _capMs = FROG_SLEEP_MAX_MS;
+};
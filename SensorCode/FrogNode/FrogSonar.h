@@ -0,0 +1,173 @@
+#pragma once
+
+// --- FrogSonar ---
+// HC-SR04 water level without pulseIn(). pulseIn() held loop() for the
+// whole echo (up to 30 ms when nothing came back), and one ping with a
+// fixed speed of sound went straight into the log.
+//
+// Here the echo pin has a CHANGE interrupt that timestamps both edges, so
+// nothing waits for the echo. A reading is a burst of FROG_SONAR_PINGS
+// pings, one per FROG_SONAR_GAP_MS pass of the sonar task:
+//
+//   start()  arms a burst (from the sensor's fast task)
+//   poll()   collects the last ping's echo and fires the next one; after
+//            the last ping it returns the level, NAN before that
+//
+// Pings with no echo are dropped, and so are echoes more than
+// FROG_SONAR_OUTLIER_CM from the burst's median (the tank wall, a ripple).
+// The rest are averaged. Fewer than FROG_SONAR_MIN_ECHOES survivors and
+// the burst publishes nothing. The speed of sound comes from the air
+// temperature of the same sensor's DHT; 20 °C when it has none.
+
+#include <Arduino.h>
+#include <algorithm>
+
+#ifndef FROG_SONAR_PINGS
+#define FROG_SONAR_PINGS 5
+#endif
+#ifndef FROG_SONAR_GAP_MS
+#define FROG_SONAR_GAP_MS 60  // HC-SR04: let the last ping's echoes die out
+#endif
+#ifndef FROG_SONAR_TIMEOUT_US
+#define FROG_SONAR_TIMEOUT_US 30000  // ~5 m, i.e. no echo
+#endif
+#ifndef FROG_SONAR_MIN_ECHOES
+#define FROG_SONAR_MIN_ECHOES 3
+#endif
+#ifndef FROG_SONAR_OUTLIER_CM
+#define FROG_SONAR_OUTLIER_CM 1.0f
+#endif
+
+struct FrogSonarStats {
+  uint32_t bursts = 0;
+  uint32_t failed = 0;    // bursts with too few good echoes
+  uint32_t pings = 0;
+  uint32_t missed = 0;    // no echo, or not within FROG_SONAR_TIMEOUT_US
+  uint32_t outliers = 0;
+  float cm = NAN;         // last published distance
+  float spreadCm = NAN;   // max - min of the echoes it was averaged from
+  float airTempC = NAN;   // used for the speed of sound
+};
+
+class FrogSonar {
+public:
+  FrogSonar(uint8_t trig, uint8_t echo, float fullCm) : _trig(trig), _echo(echo), _fullCm(fullCm) {}
+
+  void begin(const char* name) {
+    pinMode(_trig, OUTPUT);
+    digitalWrite(_trig, LOW);
+    pinMode(_echo, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(_echo), onEdge, this, CHANGE);
+    Serial.printf("[INIT] Sonar '%s' TRIG GPIO%d ECHO GPIO%d\n", name, _trig, _echo);
+  }
+
+  // Arm a burst unless one is still running.
+  void start(float airTempC) {
+    if (_ping != 0) return;
+    _airTempC = isnan(airTempC) ? 20.0f : airTempC;
+    _count = 0;
+    _ping = 1;
+  }
+
+  float poll() {
+    if (_ping == 0) return NAN;
+    if (_ping > 1) collect();
+    if (_ping <= FROG_SONAR_PINGS) {
+      fire();
+      _ping++;
+      return NAN;
+    }
+    _ping = 0;
+    return finish();
+  }
+
+  const FrogSonarStats& stats() const { return _stats; }
+
+  void printStats(Print& out, const char* name) const {
+    out.printf("[SONAR] %s %.2fcm spread=%.2fcm at %.1fC | bursts=%lu failed=%lu pings=%lu missed=%lu outliers=%lu\n",
+               name, _stats.cm, _stats.spreadCm, _stats.airTempC, (unsigned long)_stats.bursts,
+               (unsigned long)_stats.failed, (unsigned long)_stats.pings, (unsigned long)_stats.missed,
+               (unsigned long)_stats.outliers);
+  }
+
+private:
+  // First edge after the trigger is the echo starting, the second its end.
+  static void IRAM_ATTR onEdge(void* arg) {
+    FrogSonar* s = (FrogSonar*)arg;
+    uint32_t now = micros();
+    if (s->_edges == 0) {
+      s->_riseUs = now;
+    } else if (s->_edges == 1) {
+      s->_echoUs = now - s->_riseUs;
+    }
+    s->_edges++;
+  }
+
+  void fire() {
+    _edges = 0;
+    digitalWrite(_trig, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(_trig, LOW);
+    _stats.pings++;
+  }
+
+  void collect() {
+    noInterrupts();
+    uint8_t edges = _edges;
+    uint32_t echoUs = _echoUs;
+    _edges = 2;  // ignore stragglers until the next fire()
+    interrupts();
+    if (edges < 2 || echoUs >= FROG_SONAR_TIMEOUT_US) {
+      _stats.missed++;
+      return;
+    }
+    _echoes[_count++] = echoUs;
+  }
+
+  float finish() {
+    _stats.bursts++;
+    if (_count < FROG_SONAR_MIN_ECHOES) {
+      _stats.failed++;
+      return NAN;
+    }
+    // Round trip at 331.3 + 0.606 m/s per °C.
+    float cmPerUs = (331.3f + 0.606f * _airTempC) / 10000.0f / 2.0f;
+    std::sort(_echoes, _echoes + _count);
+    float median = _echoes[_count / 2] * cmPerUs;
+    float sum = 0, lo = 1e9f, hi = 0;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      float cm = _echoes[i] * cmPerUs;
+      if (fabsf(cm - median) > FROG_SONAR_OUTLIER_CM) {
+        _stats.outliers++;
+        continue;
+      }
+      sum += cm;
+      lo = min(lo, cm);
+      hi = max(hi, cm);
+      kept++;
+    }
+    if (kept < FROG_SONAR_MIN_ECHOES) {
+      _stats.failed++;
+      return NAN;
+    }
+    float cm = sum / kept;
+    _stats.cm = cm;
+    _stats.spreadCm = hi - lo;
+    _stats.airTempC = _airTempC;
+    float percent = 100.0f - (cm / _fullCm) * 100.0f;
+    return percent < 0 ? 0 : (percent > 100 ? 100 : percent);
+  }
+
+  uint8_t _trig;
+  uint8_t _echo;
+  float _fullCm;
+  float _airTempC = 20.0f;
+  uint8_t _ping = 0;  // next ping of the burst, 1-based; 0 = idle
+  uint32_t _echoes[FROG_SONAR_PINGS];
+  uint8_t _count = 0;
+  volatile uint8_t _edges = 2;
+  volatile uint32_t _riseUs = 0;
+  volatile uint32_t _echoUs = 0;
+  FrogSonarStats _stats;
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+// --- FrogSpool ---
+// Store-and-forward for readings that could not be delivered. Instead of
+// dropping a cycle (or rebooting) while Wi-Fi or the server is down, the
+// readings go into a bounded ring buffer that survives a reset:
+//
+//   ESP32    RTC slow memory (RTC_NOINIT_ATTR) - survives ESP.restart(),
+//            watchdog/panic resets and deep sleep, not a power cut.
+//   ESP8266  a file on LittleFS, a header and then the ring's slots -
+//            survives everything, and is only written while the node is
+//            offline. It grows as slots are first used, up to
+//            FROG_SPOOL_CAPACITY records.
+//
+// When the ring is full the oldest reading is overwritten. Once the uplink
+// works again, drain() sends the backlog oldest-first in batches of
+// FROG_SPOOL_BATCH, at most one batch per FROG_SPOOL_DRAIN_MS, so a long
+// outage does not hit the server with one huge burst.
+
+#include <Arduino.h>
+#include <FrogReading.h>
+#include <FrogPack.h>
+#include <FrogUplink.h>
+#include <FrogClock.h>
+#if defined(ESP8266)
+#include <LittleFS.h>
+#endif
+
+#ifndef FROG_SPOOL_CAPACITY
+#if defined(ESP8266)
+#define FROG_SPOOL_CAPACITY 512
+#else
+#define FROG_SPOOL_CAPACITY 128  // 32 bytes each, fits in 8 KB RTC memory
+#endif
+#endif
+#ifndef FROG_SPOOL_BATCH
+#define FROG_SPOOL_BATCH 12
+#endif
+#ifndef FROG_SPOOL_DRAIN_MS
+#define FROG_SPOOL_DRAIN_MS 2000
+#endif
+
+#define FROG_SPOOL_MAGIC 0x46524F48UL  // "FROH": bumped when the record layout changes
+
+// frogSendOrSpool()'s result when the readings only joined the backlog and
+// no POST was due yet. Not a failure: the last real HTTP code still stands.
+#define FROG_SEND_DEFERRED 0
+
+struct FrogSpoolRecord {
+  uint32_t ts;
+  uint32_t seq;
+  uint8_t sensor;  // index into the node's sensor name table
+  uint8_t mask;    // bit c set = value[c] present
+  uint16_t reserved;
+  float value[CH_COUNT];
+};
+
+struct FrogSpoolHeader {
+  uint32_t magic;
+  uint32_t tableHash;  // sensor name table the records refer to
+  uint16_t head;       // oldest record
+  uint16_t count;
+  uint32_t dropped;    // overwritten before they could be sent
+  uint32_t check;
+};
+
+#if !defined(ESP8266)
+struct FrogSpoolRtc {
+  FrogSpoolHeader header;
+  FrogSpoolRecord records[FROG_SPOOL_CAPACITY];
+};
+RTC_NOINIT_ATTR static FrogSpoolRtc frogSpoolRtc;
+#endif
+
+// The spool file, opened once per push or drain rather than once per
+// record. RTC memory needs no handle.
+#if defined(ESP8266)
+typedef File FrogSpoolFile;
+#else
+struct FrogSpoolFile {};
+#endif
+
+class FrogSpool {
+public:
+  // names: the node's sensor names; readings are stored by index into it.
+  // ids: their wire IDs, same order.
+  void begin(const char* const* names, const uint8_t* ids, uint8_t count) {
+    _names = names;
+    _ids = ids;
+    _nameCount = count;
+    uint32_t hash = frogTableHash(names, count);
+#if defined(ESP8266)
+    LittleFS.begin();
+    File f = LittleFS.open("/spool.bin", "r");
+    if (!f || f.read((uint8_t*)&_header, sizeof(_header)) != sizeof(_header)) _header.magic = 0;
+    if (f) f.close();
+#else
+    _header = frogSpoolRtc.header;
+#endif
+    if (_header.magic != FROG_SPOOL_MAGIC || _header.check != headerCheck(_header) ||
+        _header.tableHash != hash || _header.head >= FROG_SPOOL_CAPACITY ||
+        _header.count > FROG_SPOOL_CAPACITY) {
+      _header = FrogSpoolHeader{FROG_SPOOL_MAGIC, hash, 0, 0, 0, 0};
+      saveHeader();
+    }
+    if (_header.count) Serial.printf("[SPOOL] %u readings waiting from before reset\n", _header.count);
+  }
+
+  void push(const FrogReading* readings, uint8_t count) {
+    FrogSpoolFile f = openFile();
+    for (uint8_t i = 0; i < count; i++) {
+      const FrogReading& r = readings[i];
+      FrogSpoolRecord rec = {};
+      rec.ts = r.ts;
+      rec.seq = r.seq;
+      rec.sensor = indexOf(r.sensor);
+      for (uint8_t c = 0; c < CH_COUNT; c++) {
+        rec.value[c] = r.value[c];
+        if (r.has((FrogChannel)c)) rec.mask |= 1 << c;
+      }
+      uint16_t slot = (_header.head + _header.count) % FROG_SPOOL_CAPACITY;
+      if (_header.count == FROG_SPOOL_CAPACITY) {
+        _header.head = (_header.head + 1) % FROG_SPOOL_CAPACITY;  // drop the oldest
+        _header.dropped++;
+      } else {
+        _header.count++;
+      }
+      writeSlot(f, slot, rec);
+    }
+    saveHeader(f);
+    closeFile(f);
+  }
+
+  // Readings that did not fit in a live batch; spooled to go out with the
+  // backlog.
+  void pushOverflow(const FrogReading* readings, uint8_t count) {
+    push(readings, count);
+    _overflowed += count;
+  }
+
+  // Send up to FROG_SPOOL_BATCH spooled readings, rate-limited. Returns the
+  // HTTP code, -1 when offline, or FROG_SEND_DEFERRED when nothing was due.
+  int drain(FrogUplink& uplink) {
+    if (_header.count == 0) return FROG_SEND_DEFERRED;
+    if (WiFi.status() != WL_CONNECTED) return -1;
+    if (_lastDrain && millis() - _lastDrain < FROG_SPOOL_DRAIN_MS) return FROG_SEND_DEFERRED;
+    _lastDrain = millis();
+
+    FrogSpoolFile f = openFile();
+    FrogBatchBuffer<1024> batch(uplink.format());
+    uint16_t n = 0;
+    while (n < _header.count && n < FROG_SPOOL_BATCH) {
+      FrogSpoolRecord rec;
+      readSlot(f, (_header.head + n) % FROG_SPOOL_CAPACITY, rec);
+      if (!batch.add(toReading(rec))) break;
+      n++;
+    }
+    if (n == 0) {
+      closeFile(f);
+      return FROG_SEND_DEFERRED;
+    }
+
+    int code = uplink.post(batch);
+    Serial.printf("[SPOOL] Sent %u of %u backlog readings: HTTP %d\n", n, _header.count, code);
+    if (code == 200) {
+      _header.head = (_header.head + n) % FROG_SPOOL_CAPACITY;
+      _header.count -= n;
+      saveHeader(f);
+    }
+    closeFile(f);
+    return code;
+  }
+
+  uint16_t size() const { return _header.count; }
+  uint32_t dropped() const { return _header.dropped; }
+  uint32_t overflowed() const { return _overflowed; }
+
+private:
+  FrogReading toReading(const FrogSpoolRecord& rec) const {
+    FrogReading r(rec.sensor < _nameCount ? _names[rec.sensor] : "unknown");
+    r.id = rec.sensor < _nameCount ? _ids[rec.sensor] : 0;
+    r.ts = rec.ts;
+    r.seq = rec.seq;
+    for (uint8_t c = 0; c < CH_COUNT; c++) {
+      if (rec.mask & (1 << c)) r.value[c] = rec.value[c];
+    }
+    return r;
+  }
+
+  uint8_t indexOf(const char* name) const {
+    for (uint8_t i = 0; i < _nameCount; i++) {
+      if (_names[i] == name || strcmp(_names[i], name) == 0) return i;
+    }
+    return 0xFF;
+  }
+
+  static uint32_t headerCheck(const FrogSpoolHeader& h) {
+    return h.magic ^ h.tableHash ^ ((uint32_t)h.head << 16 | h.count) ^ h.dropped ^ 0xA5A5A5A5UL;
+  }
+
+  FrogSpoolFile openFile() {
+#if defined(ESP8266)
+    return LittleFS.open("/spool.bin", LittleFS.exists("/spool.bin") ? "r+" : "w+");
+#else
+    return {};
+#endif
+  }
+
+  void closeFile(FrogSpoolFile& f) {
+#if defined(ESP8266)
+    f.close();
+#else
+    (void)f;
+#endif
+  }
+
+  void saveHeader() {
+    FrogSpoolFile f = openFile();
+    saveHeader(f);
+    closeFile(f);
+  }
+
+  void saveHeader(FrogSpoolFile& f) {
+    _header.check = headerCheck(_header);
+#if defined(ESP8266)
+    if (!f) return;
+    f.seek(0);
+    f.write((const uint8_t*)&_header, sizeof(_header));
+#else
+    (void)f;
+    frogSpoolRtc.header = _header;
+#endif
+  }
+
+  void writeSlot(FrogSpoolFile& f, uint16_t slot, const FrogSpoolRecord& rec) {
+#if defined(ESP8266)
+    if (!f) return;
+    f.seek(sizeof(FrogSpoolHeader) + (size_t)slot * sizeof(FrogSpoolRecord));
+    f.write((const uint8_t*)&rec, sizeof(rec));
+#else
+    (void)f;
+    frogSpoolRtc.records[slot] = rec;
+#endif
+  }
+
+  void readSlot(FrogSpoolFile& f, uint16_t slot, FrogSpoolRecord& rec) const {
+#if defined(ESP8266)
+    memset(&rec, 0, sizeof(rec));
+    if (!f) return;
+    f.seek(sizeof(FrogSpoolHeader) + (size_t)slot * sizeof(FrogSpoolRecord));
+    f.read((uint8_t*)&rec, sizeof(rec));
+#else
+    (void)f;
+    rec = frogSpoolRtc.records[slot];
+#endif
+  }
+
+  FrogSpoolHeader _header = {};
+  const char* const* _names = nullptr;
+  const uint8_t* _ids = nullptr;
+  uint8_t _nameCount = 0;
+  unsigned long _lastDrain = 0;
+  uint32_t _overflowed = 0;
+};
+
+// Send one cycle's readings in a single POST. Anything that cannot be
+// delivered right now is spooled for later, as is anything that does not
+// fit in the batch buffer. While a backlog is still draining, new readings
+// queue behind it so the server gets rows in time order. Returns the HTTP
+// code, -1 when nothing could be delivered, or FROG_SEND_DEFERRED when the
+// readings joined the backlog and its next POST is not due yet.
+inline int frogSendOrSpool(FrogUplink& uplink, FrogSpool& spool, const FrogReading* readings, uint8_t count) {
+  if (count == 0) return -1;
+  if (spool.size() > 0) {
+    spool.push(readings, count);
+    return spool.drain(uplink);
+  }
+  int code = -1;
+  if (WiFi.status() == WL_CONNECTED) {
+    FrogBatchBuffer<512> batch(uplink.format());
+    uint8_t fit = 0;
+    while (fit < count && batch.add(readings[fit])) fit++;
+    batch.finish();
+    if (batch.format() == FROG_JSON) {
+      Serial.printf("[BATCH] Sending %u readings: %s\n", batch.count(), (const char*)batch.data());
+    } else {
+      Serial.printf("[BATCH] Sending %u readings: %u bytes of %s\n", batch.count(), (unsigned)batch.length(),
+                    batch.contentType());
+    }
+    code = uplink.post(batch);
+    Serial.printf("[BATCH] HTTP %d\n", code);
+    if (code == 200 && fit < count) {
+      spool.pushOverflow(readings + fit, count - fit);
+      Serial.printf("[SPOOL] %u readings did not fit in the batch, spooled\n", count - fit);
+    }
+  } else {
+    Serial.println("[WARN] Wi-Fi not connected, spooling readings.");
+  }
+  if (code != 200) {
+    spool.push(readings, count);
+    Serial.printf("[SPOOL] %u readings waiting (%lu dropped)\n", spool.size(), (unsigned long)spool.dropped());
+  }
+  return code;
+}
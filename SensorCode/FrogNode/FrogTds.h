@@ -0,0 +1,299 @@
+#pragma once
+
+// --- FrogTds ---
+// TDS probe acquisition. A single analogRead() on the ESP32 is noisy
+// enough to move the ppm figure by tens of ppm from one report to the
+// next. Instead, each reading comes from a burst of FROG_TDS_SAMPLES
+// conversions:
+//
+//   1. ESP32 continuous ADC (DMA). FrogAdcDma starts a burst, the DMA fills
+//      its buffer at FROG_TDS_SAMPLE_HZ while the CPU does other work, and
+//      the next pass of the sampling task collects it. Only ADC1 pins can
+//      do this; ADC2 pins and the ESP8266 take FROG_TDS_POLL_SAMPLES
+//      analogRead()s in a row instead.
+//   2. The median of the burst, so a spike from the pump or the Wi-Fi radio
+//      does not pull it.
+//   3. Raw code -> millivolts through a calibration table (FrogCalPoint),
+//      which takes out the ADC's nonlinearity at both ends of the range.
+//   4. Temperature compensation (2 %/°C from 25 °C), the probe's cubic
+//      curve, and an IIR filter (FROG_TDS_IIR) across bursts.
+//
+// Every stage is kept in FrogTdsStats and printed as a [TDS] line with the
+// node's other stats, so the numbers can be tuned on a live tank.
+//
+// The continuous driver owns ADC1 while it runs, so no other ADC1 pin on
+// the node may use analogRead().
+
+#include <Arduino.h>
+#include <algorithm>
+#if !defined(ESP8266)
+#include <esp_adc/adc_continuous.h>
+#endif
+
+#ifndef FROG_TDS_SAMPLES
+#define FROG_TDS_SAMPLES 512  // per reading, DMA path
+#endif
+#ifndef FROG_TDS_POLL_SAMPLES
+#define FROG_TDS_POLL_SAMPLES 32  // per reading, analogRead() path
+#endif
+#ifndef FROG_TDS_SAMPLE_HZ
+#define FROG_TDS_SAMPLE_HZ 20000  // lowest the ESP32 continuous ADC allows
+#endif
+#ifndef FROG_TDS_IIR
+#define FROG_TDS_IIR 0.25f  // weight of the newest burst
+#endif
+#ifndef FROG_TDS_CHANNELS
+#define FROG_TDS_CHANNELS 2  // DMA channels per node
+#endif
+
+// One point of an ADC transfer curve: what the ADC reads at a known input.
+struct FrogCalPoint {
+  uint16_t raw;
+  uint16_t mv;
+};
+
+// Typical ESP32 ADC1 at 11/12 dB: nothing below ~140 mV, then about
+// 0.8 mV per code, flattening out above ~2.6 V. Measure a few known
+// voltages on your board and pass your own table with .tdsCalibration().
+constexpr FrogCalPoint kFrogAdcCal[] = {
+  {0, 0},       {1, 142},     {500, 552},   {1000, 962},  {1500, 1372},
+  {2000, 1782}, {2500, 2192}, {3000, 2602}, {3500, 2985}, {3900, 3175},
+  {4095, 3300},
+};
+
+// Piecewise-linear lookup; raw may be fractional (a median of two codes).
+inline float frogAdcToMv(float raw, const FrogCalPoint* table, uint8_t n) {
+  if (raw <= table[0].raw) return table[0].mv;
+  for (uint8_t i = 1; i < n; i++) {
+    if (raw <= table[i].raw) {
+      const FrogCalPoint& a = table[i - 1];
+      const FrogCalPoint& b = table[i];
+      return a.mv + (raw - a.raw) * (b.mv - a.mv) / (float)(b.raw - a.raw);
+    }
+  }
+  return table[n - 1].mv;
+}
+
+#if !defined(ESP8266)
+// --- FrogAdcDma ---
+// One continuous-ADC driver shared by every DMA-capable TDS pin on the
+// node. Bursts are started and collected from the sampling task; nothing
+// waits for the conversion.
+class FrogAdcDma {
+public:
+  // Returns false when the pin is not on ADC1 or every channel is taken.
+  static bool add(uint8_t pin) {
+    int8_t channel = digitalPinToAnalogChannel(pin);
+    if (channel < 0 || channel >= SOC_ADC_CHANNEL_NUM(ADC_UNIT_1) || _count >= FROG_TDS_CHANNELS) return false;
+    if (_handle) return false;  // channels are fixed once the driver runs
+    _pins[_count] = pin;
+    _channels[_count] = (uint8_t)channel;
+    _count++;
+    return true;
+  }
+
+  // Copy the newest finished burst for pin into out. Returns how many
+  // samples it had, or 0 when none is ready yet; a new burst is then
+  // started if none is running. Called once per sampling pass, that is a
+  // burst every other pass.
+  static uint16_t take(uint8_t pin, uint16_t* out) {
+    uint8_t slot = slotOf(pin);
+    if (slot >= _count) return 0;
+    if (!_ready[slot]) {
+      if (_running) {
+        harvest();
+      } else {
+        start();
+      }
+    }
+    if (!_ready[slot]) return 0;
+    _ready[slot] = false;
+    memcpy(out, _samples[slot], _n[slot] * sizeof(uint16_t));
+    return _n[slot];
+  }
+
+  static uint32_t overruns() { return _overruns; }
+
+private:
+  static uint8_t slotOf(uint8_t pin) {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_pins[i] == pin) return i;
+    }
+    return 0xFF;
+  }
+
+  static bool begin() {
+    adc_continuous_handle_cfg_t handleCfg = {};
+    handleCfg.max_store_buf_size = FROG_TDS_SAMPLES * _count * SOC_ADC_DIGI_RESULT_BYTES;
+    handleCfg.conv_frame_size = 64 * SOC_ADC_DIGI_RESULT_BYTES;
+    if (adc_continuous_new_handle(&handleCfg, &_handle) != ESP_OK) {
+      _handle = nullptr;
+      return false;
+    }
+    adc_digi_pattern_config_t pattern[FROG_TDS_CHANNELS] = {};
+    for (uint8_t i = 0; i < _count; i++) {
+      pattern[i].atten = ADC_ATTEN_DB_12;
+      pattern[i].channel = _channels[i];
+      pattern[i].unit = ADC_UNIT_1;
+      pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    adc_continuous_config_t cfg = {};
+    cfg.pattern_num = _count;
+    cfg.adc_pattern = pattern;
+    cfg.sample_freq_hz = FROG_TDS_SAMPLE_HZ;
+    cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+    cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+#else
+    cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+#endif
+    if (adc_continuous_config(_handle, &cfg) != ESP_OK) {
+      Serial.println("[ERROR] Continuous ADC config failed");
+      return false;
+    }
+    return true;
+  }
+
+  static void start() {
+    if (!_handle && !begin()) return;
+    for (uint8_t i = 0; i < _count; i++) _n[i] = 0;
+    _running = adc_continuous_start(_handle) == ESP_OK;
+  }
+
+  // Read whatever the DMA has converted since start() and stop it.
+  static void harvest() {
+    uint8_t buf[64 * SOC_ADC_DIGI_RESULT_BYTES];
+    uint32_t got = 0;
+    while (adc_continuous_read(_handle, buf, sizeof(buf), &got, 0) == ESP_OK && got > 0) {
+      for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= got; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* p = (const adc_digi_output_data_t*)&buf[i];
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+        uint8_t channel = p->type1.channel;
+        uint16_t data = p->type1.data;
+#else
+        uint8_t channel = p->type2.channel;
+        uint16_t data = p->type2.data;
+#endif
+        for (uint8_t s = 0; s < _count; s++) {
+          if (_channels[s] != channel) continue;
+          if (_n[s] < FROG_TDS_SAMPLES) {
+            _samples[s][_n[s]++] = data;
+          } else {
+            _overruns++;
+          }
+        }
+      }
+    }
+    adc_continuous_stop(_handle);
+    _running = false;
+    for (uint8_t i = 0; i < _count; i++) _ready[i] = _n[i] > 0;
+  }
+
+  static inline adc_continuous_handle_t _handle = nullptr;
+  static inline uint8_t _count = 0;
+  static inline uint8_t _pins[FROG_TDS_CHANNELS] = {};
+  static inline uint8_t _channels[FROG_TDS_CHANNELS] = {};
+  static inline uint16_t _samples[FROG_TDS_CHANNELS][FROG_TDS_SAMPLES];
+  static inline uint16_t _n[FROG_TDS_CHANNELS] = {};
+  static inline bool _ready[FROG_TDS_CHANNELS] = {};
+  static inline bool _running = false;
+  static inline uint32_t _overruns = 0;  // samples past FROG_TDS_SAMPLES
+};
+#endif
+
+struct FrogTdsStats {
+  uint32_t bursts = 0;
+  uint16_t samples = 0;  // in the last burst
+  uint16_t rawMin = 0;
+  uint16_t rawMax = 0;
+  float rawMedian = NAN;
+  float rawMean = NAN;
+  float rawStdDev = NAN;
+  float millivolts = NAN;  // median through the calibration table
+  float ppmBurst = NAN;    // this burst alone
+  float ppm = NAN;         // after the IIR filter
+};
+
+// --- FrogTds ---
+// One TDS probe. read() never waits for the ADC; it returns NAN when no
+// new burst has finished since the last call.
+class FrogTds {
+public:
+  FrogTds(uint8_t pin, float waterTempC, const FrogCalPoint* cal, uint8_t calCount)
+      : _pin(pin), _tempC(waterTempC), _cal(cal), _calCount(calCount) {}
+
+  void begin(const char* name) {
+#if !defined(ESP8266)
+    _dma = FrogAdcDma::add(_pin);
+#endif
+    Serial.printf("[INIT] TDS '%s' on GPIO%d (%s)\n", name, _pin, _dma ? "continuous ADC" : "analogRead");
+  }
+
+  float read() {
+    uint16_t n = 0;
+#if !defined(ESP8266)
+    if (_dma) n = FrogAdcDma::take(_pin, _buf);
+#endif
+    if (!_dma) {
+      for (; n < FROG_TDS_POLL_SAMPLES; n++) _buf[n] = (uint16_t)analogRead(_pin);
+    }
+    if (n == 0) return NAN;
+
+    summarize(n);
+    float volts = frogAdcToMv(_stats.rawMedian, _cal, _calCount) / 1000.0f;
+    _stats.millivolts = volts * 1000.0f;
+    volts /= 1.0f + 0.02f * (_tempC - 25.0f);
+    // CQRobot/DFRobot probe curve
+    float ppm = (133.42f * volts * volts * volts - 255.86f * volts * volts + 857.39f * volts) * 0.5f;
+    _stats.ppmBurst = ppm;
+    _stats.ppm = isnan(_stats.ppm) ? ppm : _stats.ppm + FROG_TDS_IIR * (ppm - _stats.ppm);
+    return _stats.ppm;
+  }
+
+  const FrogTdsStats& stats() const { return _stats; }
+
+  void printStats(Print& out, const char* name) const {
+    out.printf("[TDS] %s n=%u raw med=%.1f mean=%.1f sd=%.1f min=%u max=%u | %.0fmV %.1fppm -> %.1fppm (%lu bursts",
+               name, _stats.samples, _stats.rawMedian, _stats.rawMean, _stats.rawStdDev, _stats.rawMin,
+               _stats.rawMax, _stats.millivolts, _stats.ppmBurst, _stats.ppm, (unsigned long)_stats.bursts);
+#if !defined(ESP8266)
+    if (_dma) out.printf(", %lu overruns", (unsigned long)FrogAdcDma::overruns());
+#endif
+    out.print(")\n");
+  }
+
+private:
+  void summarize(uint16_t n) {
+    uint32_t sum = 0;
+    uint16_t lo = 0xFFFF, hi = 0;
+    for (uint16_t i = 0; i < n; i++) {
+      sum += _buf[i];
+      lo = min(lo, _buf[i]);
+      hi = max(hi, _buf[i]);
+    }
+    float mean = (float)sum / n;
+    float var = 0;
+    for (uint16_t i = 0; i < n; i++) var += (_buf[i] - mean) * (_buf[i] - mean);
+
+    uint16_t* mid = _buf + n / 2;
+    std::nth_element(_buf, mid, _buf + n);
+    float median = *mid;
+    if (n % 2 == 0) median = (median + *std::max_element(_buf, mid)) / 2.0f;
+
+    _stats.bursts++;
+    _stats.samples = n;
+    _stats.rawMin = lo;
+    _stats.rawMax = hi;
+    _stats.rawMean = mean;
+    _stats.rawStdDev = sqrtf(var / n);
+    _stats.rawMedian = median;
+  }
+
+  uint8_t _pin;
+  float _tempC;
+  const FrogCalPoint* _cal;
+  uint8_t _calCount;
+  bool _dma = false;
+  uint16_t _buf[FROG_TDS_SAMPLES > FROG_TDS_POLL_SAMPLES ? FROG_TDS_SAMPLES : FROG_TDS_POLL_SAMPLES];
+  FrogTdsStats _stats;
+};
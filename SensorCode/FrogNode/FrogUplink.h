@@ -0,0 +1,147 @@
+#pragma once
+
+// --- FrogUplink ---
+// One keep-alive HTTPS connection to the Frog API, shared by every POST a
+// node makes. The TLS handshake happens once and the socket stays open
+// between report cycles; if the server (or nginx) closes it, the next POST
+// reconnects and retries once. On the ESP8266 the BearSSL session is cached
+// so a reconnect resumes the session instead of doing a full handshake.
+//
+// The uplink also knows the node's payload format (FrogPack.h), so the
+// batch and spool code build bodies the server is told to expect.
+
+#include <Arduino.h>
+#if defined(ESP8266)
+#include <ESP8266WiFi.h>
+#include <ESP8266HTTPClient.h>
+#else
+#include <WiFi.h>
+#include <HTTPClient.h>
+#endif
+#include <WiFiClientSecure.h>
+#include <FrogPack.h>
+
+struct UplinkStats {
+  uint32_t posts = 0;
+  uint32_t failures = 0;
+  uint32_t handshakes = 0;
+  uint32_t reconnects = 0;         // server closed a reused connection
+  uint32_t lastHandshakeMs = 0;
+  uint32_t totalHandshakeMs = 0;
+  uint32_t lastPostMs = 0;
+  uint32_t totalPostMs = 0;
+};
+
+class FrogUplink {
+public:
+  // url: "https://host[:port]/path". The string must outlive the uplink.
+  void begin(const char* url, FrogFormat format = FROG_JSON) {
+    parseUrl(url);
+    _format = format;
+    _client.setInsecure();  // skip SSL cert validation, same as before
+#if defined(ESP8266)
+    _client.setSession(&_session);
+#endif
+    _http.setReuse(true);
+  }
+
+  // POST one body over the shared connection. Returns the HTTP code, or a
+  // negative HTTPClient error when the request never got an answer.
+  int post(const char* body, size_t len, const char* contentType = "application/json") {
+    int code = send(body, len, contentType);
+    if (code < 0 && _reused) {
+      // The server dropped the idle connection under us: start over once.
+      _stats.reconnects++;
+      _client.stop();
+      code = send(body, len, contentType);
+    }
+    _stats.posts++;
+    if (code != 200) _stats.failures++;
+    return code;
+  }
+
+  // Build the batch in the uplink's format and POST it.
+  int post(FrogBatch& batch) {
+    batch.finish();
+    return post((const char*)batch.data(), batch.length(), batch.contentType());
+  }
+
+  FrogFormat format() const { return _format; }
+
+  bool connected() { return _client.connected(); }
+
+  void close() {
+    _http.end();
+    _client.stop();
+  }
+
+  const UplinkStats& stats() const { return _stats; }
+
+  void printStats(Print& out) const {
+    uint32_t avgHs = _stats.handshakes ? _stats.totalHandshakeMs / _stats.handshakes : 0;
+    uint32_t avgPost = _stats.posts ? _stats.totalPostMs / _stats.posts : 0;
+    out.printf("[UPLINK] posts=%lu failed=%lu handshakes=%lu reconnects=%lu\n",
+               (unsigned long)_stats.posts, (unsigned long)_stats.failures,
+               (unsigned long)_stats.handshakes, (unsigned long)_stats.reconnects);
+    out.printf("[UPLINK] handshake last=%lums avg=%lums | post last=%lums avg=%lums\n",
+               (unsigned long)_stats.lastHandshakeMs, (unsigned long)avgHs,
+               (unsigned long)_stats.lastPostMs, (unsigned long)avgPost);
+  }
+
+private:
+  int send(const char* body, size_t len, const char* contentType) {
+    _reused = _client.connected();
+    if (!_reused && !handshake()) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    unsigned long start = millis();
+    _http.begin(_client, _host, _port, _path, true);
+    _http.addHeader("Content-Type", contentType);
+    int code = _http.POST((uint8_t*)body, len);
+    if (code > 0) _http.getString();  // drain the body so the socket can be reused
+    _http.end();                      // keeps the connection open (setReuse)
+    _stats.lastPostMs = millis() - start;
+    _stats.totalPostMs += _stats.lastPostMs;
+    return code;
+  }
+
+  bool handshake() {
+    unsigned long start = millis();
+    bool ok = _client.connect(_host, _port);
+    _stats.lastHandshakeMs = millis() - start;
+    if (ok) {
+      _stats.handshakes++;
+      _stats.totalHandshakeMs += _stats.lastHandshakeMs;
+    }
+    return ok;
+  }
+
+  void parseUrl(const char* url) {
+    const char* p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    const char* slash = strchr(p, '/');
+    const char* colon = strchr(p, ':');
+    const char* hostEnd = slash ? slash : p + strlen(p);
+    _port = 443;
+    if (colon && colon < hostEnd) {
+      _port = (uint16_t)atoi(colon + 1);
+      hostEnd = colon;
+    }
+    size_t n = min((size_t)(hostEnd - p), sizeof(_host) - 1);
+    memcpy(_host, p, n);
+    _host[n] = '\0';
+    strncpy(_path, slash ? slash : "/", sizeof(_path) - 1);
+    _path[sizeof(_path) - 1] = '\0';
+  }
+
+  WiFiClientSecure _client;
+  HTTPClient _http;
+#if defined(ESP8266)
+  BearSSL::Session _session;
+#endif
+  char _host[64] = "";
+  char _path[96] = "/";
+  uint16_t _port = 443;
+  bool _reused = false;
+  FrogFormat _format = FROG_JSON;
+  UplinkStats _stats;
+};
@@ -0,0 +1,135 @@
+// Host-side test for frogDhtDecode(): fixed DHT11 and DHT22 frames, fed to
+// it the two ways FrogDht captures them (RMT symbols on the ESP32, edge
+// timestamps from the CHANGE interrupt elsewhere).
+//
+//   g++ -O2 -std=gnu++17 -I.. -I../../host/fakes dht_decode_test.cpp -o dht_decode_test && ./dht_decode_test
+//
+// Exits non-zero on the first failed check.
+
+#include <FrogDht.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static int gChecks = 0;
+
+#define CHECK(cond)                                                         \
+  do {                                                                      \
+    gChecks++;                                                              \
+    if (!(cond)) {                                                          \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      exit(1);                                                              \
+    }                                                                       \
+  } while (0)
+
+// The line after the host releases it: ~30 µs of pull-up, the sensor's
+// 80 µs low / 80 µs high response, then per bit 50 µs low and a high of
+// 27 µs (0) or 70 µs (1), and a last 50 µs low before the line idles.
+// `bits` cuts the frame short.
+static uint16_t waveform(const uint8_t bytes[5], FrogPulse* out, uint8_t bits = 40) {
+  uint16_t n = 0;
+  out[n++] = {HIGH, 30};
+  out[n++] = {LOW, 80};
+  out[n++] = {HIGH, 80};
+  for (uint8_t b = 0; b < bits; b++) {
+    bool one = bytes[b / 8] & (0x80 >> (b % 8));
+    out[n++] = {LOW, 50};
+    out[n++] = {HIGH, (uint16_t)(one ? 70 : 27)};
+  }
+  out[n++] = {LOW, 50};
+  return n;
+}
+
+// As the RMT channel records it, two levels per symbol, then turned back
+// into pulses the way FrogDht::stopCapture() does.
+static uint16_t viaRmt(const FrogPulse* wave, uint16_t n, FrogPulse* out) {
+  rmt_symbol_word_t symbols[FROG_DHT_MAX_PULSES / 2] = {};
+  uint16_t count = 0;
+  for (uint16_t i = 0; i < n; i += 2) {
+    symbols[count].level0 = wave[i].level;
+    symbols[count].duration0 = wave[i].us;
+    if (i + 1 < n) {  // a zero duration marks the end of the frame
+      symbols[count].level1 = wave[i + 1].level;
+      symbols[count].duration1 = wave[i + 1].us;
+    }
+    count++;
+  }
+  uint16_t m = 0;
+  for (uint16_t i = 0; i < count && m + 2 <= FROG_DHT_MAX_PULSES; i++) {
+    out[m++] = {(uint8_t)symbols[i].level0, (uint16_t)symbols[i].duration0};
+    out[m++] = {(uint8_t)symbols[i].level1, (uint16_t)symbols[i].duration1};
+  }
+  return m;
+}
+
+// As the edge interrupt records it: a timestamp per edge, the first being
+// the sensor pulling the line low, then turned back into pulses the way
+// FrogDht::stopCapture() does.
+static uint16_t viaEdges(const FrogPulse* wave, uint16_t n, FrogPulse* out) {
+  uint32_t edgeUs[FROG_DHT_MAX_PULSES];
+  uint16_t edgeCount = 0;
+  uint32_t t = 1000000 + wave[0].us;
+  for (uint16_t i = 1; i < n && edgeCount < FROG_DHT_MAX_PULSES; i++) {
+    edgeUs[edgeCount++] = t;
+    t += wave[i].us;
+  }
+  if (edgeCount < FROG_DHT_MAX_PULSES) edgeUs[edgeCount++] = t;  // back to idle
+  uint16_t m = 0;
+  for (uint16_t i = 1; i < edgeCount; i++) {
+    out[m++] = {(uint8_t)(i % 2 == 1 ? LOW : HIGH), (uint16_t)(edgeUs[i] - edgeUs[i - 1])};
+  }
+  return m;
+}
+
+static bool near(float a, float b) { return fabsf(a - b) < 0.05f; }
+
+// Decodes one frame both ways and checks each gives the same answer.
+static void expect(uint8_t type, uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3,
+                   float tempC, float humidity) {
+  const uint8_t bytes[5] = {b0, b1, b2, b3, (uint8_t)(b0 + b1 + b2 + b3)};
+  FrogPulse wave[FROG_DHT_MAX_PULSES], pulses[FROG_DHT_MAX_PULSES];
+  uint16_t n = waveform(bytes, wave);
+  for (int form = 0; form < 2; form++) {
+    uint16_t m = form == 0 ? viaRmt(wave, n, pulses) : viaEdges(wave, n, pulses);
+    FrogDhtFrame f = frogDhtDecode(pulses, m, type);
+    CHECK(f.status == FROG_DHT_OK);
+    for (int i = 0; i < 5; i++) CHECK(f.bytes[i] == bytes[i]);
+    CHECK(near(f.tempC, tempC));
+    CHECK(near(f.humidity, humidity));
+  }
+}
+
+static void expectStatus(uint8_t type, const uint8_t bytes[5], uint8_t bits, FrogDhtStatus status) {
+  FrogPulse wave[FROG_DHT_MAX_PULSES], pulses[FROG_DHT_MAX_PULSES];
+  uint16_t n = waveform(bytes, wave, bits);
+  CHECK(frogDhtDecode(pulses, viaRmt(wave, n, pulses), type).status == status);
+  CHECK(frogDhtDecode(pulses, viaEdges(wave, n, pulses), type).status == status);
+}
+
+int main() {
+  // DHT11: whole-number bytes, sign in bit 7 of the tenths byte
+  expect(DHT11, 55, 0, 23, 4, 23.4f, 55.0f);
+  expect(DHT11, 40, 5, 3, 0x85, -3.5f, 40.5f);
+  // DHT22: 16-bit tenths, sign in bit 15 of the temperature
+  expect(DHT22, 0x02, 0x8C, 0x00, 0xFB, 25.1f, 65.2f);
+  expect(DHT22, 0x01, 0xF4, 0x80, 0x65, -10.1f, 50.0f);
+  expect(DHT22, 0x03, 0xE8, 0x01, 0x90, 40.0f, 100.0f);
+
+  const uint8_t bad[5] = {0x02, 0x8C, 0x00, 0xFB, 0x00};
+  expectStatus(DHT22, bad, 40, FROG_DHT_CHECKSUM);
+  const uint8_t good[5] = {55, 0, 23, 4, 82};
+  // The response's 80 µs high counts as a bit until 40 real ones follow
+  // it, so one lost bit shows up as a bad checksum, not a short frame
+  expectStatus(DHT11, good, 39, FROG_DHT_CHECKSUM);
+  expectStatus(DHT11, good, 38, FROG_DHT_SHORT);
+  expectStatus(DHT11, good, 12, FROG_DHT_SHORT);
+
+  // Nothing on the line at all
+  CHECK(frogDhtDecode(nullptr, 0, DHT22).status == FROG_DHT_NO_RESPONSE);
+  const FrogPulse idle[1] = {{HIGH, 6000}};
+  CHECK(frogDhtDecode(idle, 1, DHT22).status == FROG_DHT_NO_RESPONSE);
+
+  printf("dht_decode_test: %d checks passed\n", gChecks);
+  return 0;
+}
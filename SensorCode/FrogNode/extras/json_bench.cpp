@@ -0,0 +1,177 @@
+// Host-side benchmark: FrogJsonBuffer vs. the Arduino String payload code
+// the sketches used to build every reading with.
+//
+//   g++ -O2 -std=gnu++17 -I.. json_bench.cpp -o json_bench && ./json_bench
+//
+// The String path below is a stand-in for the ESP8266/ESP32 core String:
+// 11-byte small-string buffer, exact-size realloc on every concat that
+// outgrows it, and StringSumHelper-style chaining for `"lit" + String(x)`.
+// Every malloc/realloc it makes is counted.
+
+#include <FrogJson.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+static unsigned long gAllocs = 0;
+
+class String {
+public:
+  String(const char* s = "") { assign(s, strlen(s)); }
+  String(const String& o) { assign(o.c_str(), o._len); }
+  String(float v, unsigned char decimals = 2) {
+    char tmp[33];
+    snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);  // dtostrf()
+    assign(tmp, strlen(tmp));
+  }
+  ~String() {
+    if (_heap) free(_heap);
+  }
+  String& operator=(const String&) = delete;
+
+  String& operator+=(const char* s) { return concat(s, strlen(s)); }
+  String& operator+=(const String& s) { return concat(s.c_str(), s._len); }
+
+  const char* c_str() const { return _heap ? _heap : _sso; }
+  size_t length() const { return _len; }
+
+protected:
+  String& concat(const char* s, size_t n) {
+    size_t need = _len + n;
+    if (need > _cap) {
+      // WString::changeBuffer(): realloc to exactly the new length.
+      char* p = (char*)(_heap ? realloc(_heap, need + 1) : malloc(need + 1));
+      gAllocs++;
+      if (!_heap) memcpy(p, _sso, _len + 1);
+      _heap = p;
+      _cap = need;
+    }
+    char* d = _heap ? _heap : _sso;
+    memcpy(d + _len, s, n);
+    _len = need;
+    d[_len] = '\0';
+    return *this;
+  }
+
+private:
+  void assign(const char* s, size_t n) {
+    _len = 0;
+    _sso[0] = '\0';
+    concat(s, n);
+  }
+
+  char _sso[12];
+  char* _heap = nullptr;
+  size_t _len = 0;
+  size_t _cap = 11;
+};
+
+struct StringSumHelper : String {
+  StringSumHelper(const char* s) : String(s) {}
+  StringSumHelper(const String& s) : String(s) {}
+};
+
+static StringSumHelper& operator+(const StringSumHelper& lhs, const String& rhs) {
+  StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+  a += rhs;
+  return a;
+}
+
+static StringSumHelper& operator+(const StringSumHelper& lhs, const char* rhs) {
+  StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+  a += rhs;
+  return a;
+}
+
+// --- The two payload builders ---
+
+struct Sample {
+  const char* name;
+  float tempF, humidity, lux;
+};
+
+static const Sample kSamples[] = {
+  {"White Tree Frog Terrarium", 78.4f, 71.0f, 412.5f},
+  {"Bedroom", 69.8f, 38.0f, -1},
+  {"Avicularia Avicularia", 77.0f, 74.0f, -1},
+};
+static const int kSampleCount = sizeof(kSamples) / sizeof(kSamples[0]);
+
+// Exactly how ESPBedroom.cpp / ESP8266Bedroom built the batch before FrogJson.
+static size_t buildWithString(char* out, size_t cap) {
+  String batch = "[";
+  for (int i = 0; i < kSampleCount; i++) {
+    const Sample& s = kSamples[i];
+    if (i > 0) batch += ",";
+    batch += "{\"sensor\":\"" + String(s.name) +
+             "\",\"temp\":" + String(s.tempF, 1) +
+             ",\"humidity\":" + String(s.humidity, 1);
+    if (s.lux >= 0) batch += ",\"lux\":" + String(s.lux, 1);
+    batch += "}";
+  }
+  batch += "]";
+  size_t n = batch.length() < cap ? batch.length() : cap - 1;
+  memcpy(out, batch.c_str(), n);
+  out[n] = '\0';
+  return batch.length();
+}
+
+static size_t buildWithFrogJson(char* out, size_t cap) {
+  FrogJsonBuffer<384> batch;
+  for (int i = 0; i < kSampleCount; i++) {
+    const Sample& s = kSamples[i];
+    FrogReading r(s.name);
+    r.set(CH_TEMP, s.tempF).set(CH_HUMIDITY, s.humidity);
+    if (s.lux >= 0) r.set(CH_LUX, s.lux);
+    batch.add(r);
+  }
+  batch.finish();
+  size_t n = batch.length() < cap ? batch.length() : cap - 1;
+  memcpy(out, batch.c_str(), n);
+  out[n] = '\0';
+  return batch.length();
+}
+
+static inline unsigned long long cycles() {
+#ifdef HAVE_RDTSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void run(const char* label, size_t (*build)(char*, size_t), int iterations) {
+  static char out[512];
+  volatile size_t sink = 0;
+  gAllocs = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  unsigned long long c0 = cycles();
+  for (int i = 0; i < iterations; i++) sink = sink + build(out, sizeof(out));
+  unsigned long long c1 = cycles();
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+  printf("%-10s %6zu bytes  %8.1f ns  %8.0f cycles  %5.1f allocs  per payload\n",
+         label, build(out, sizeof(out)), ns, (double)(c1 - c0) / iterations,
+         (double)gAllocs / (iterations + 1));
+  (void)sink;
+}
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+
+  char a[512], b[512];
+  buildWithString(a, sizeof(a));
+  buildWithFrogJson(b, sizeof(b));
+  printf("String   : %s\nFrogJson : %s\n\n", a, b);
+
+  printf("%d payloads of %d readings each\n", iterations, kSampleCount);
+  run("String", buildWithString, iterations);
+  run("FrogJson", buildWithFrogJson, iterations);
+  return strcmp(a, b) == 0 ? 0 : 1;
+}
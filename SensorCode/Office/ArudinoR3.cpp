@@ -1,14 +1,46 @@
 #include <DHT.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+// --- Serial Frames ---
+// The Uno has no network; SerialToServer.py on the host reads its frames
+// over USB and posts them. Every message is one frame:
+//
+//   COBS( type:u8 seq:u8 body... crc:u16le ) 0x00
+//
+// crc is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over type, seq and
+// body. COBS leaves no 0x00 inside a frame, so the 0x00 after it is an
+// unambiguous delimiter: a bridge that starts mid-frame or sees a garbled
+// byte drops one frame and picks up at the next 0x00. seq counts frames
+// (mod 256) so the bridge can tell how many it lost.
+//
+// All numbers little-endian. Temperature is °F and humidity % in tenths.
+#define FRAME_HELLO 0x01    // version:u8 sensors:u8 interval_s:u16
+#define FRAME_NAME 0x02     // index:u8 name bytes
+#define FRAME_READING 0x03  // index:u8 temp:i16 humidity:u16
+#define FRAME_FAULT 0x04    // index:u8 (the DHT did not answer)
+#define FRAME_CYCLE 0x05    // readings:u8, ends a cycle's readings
+#define FRAME_LOG 0x06      // text
+
+#define FRAME_VERSION 1
+#define FRAME_MAX_PAYLOAD 48  // type + seq + body + crc, well under COBS's 254
+
+#ifndef R3_INTERVAL_MS
+#define R3_INTERVAL_MS 10000
+#endif
+#ifndef R3_NAMES_EVERY
+#define R3_NAMES_EVERY 30  // cycles; resends names for a bridge started late
+#endif
 
 // --- Sensor Config ---
 #define SENSOR_COUNT 3
 const uint8_t dhtPins[SENSOR_COUNT] = {12, 4, 14};  // DHT on pins 12, 4, 14
 
-const char* sensorNames[SENSOR_COUNT] = {
-  "Avicularia Avicularia",  // Pinktoe
-  "Red Knee",               // Red Knee
-  "Office Sensor"           // Office Temp
-};
+// Names live in flash; the Uno only has 2 KB of RAM.
+const char name0[] PROGMEM = "Avicularia Avicularia";  // Pinktoe
+const char name1[] PROGMEM = "Red Knee";               // Red Knee
+const char name2[] PROGMEM = "Office Sensor";          // Office Temp
+const char* const sensorNames[SENSOR_COUNT] PROGMEM = {name0, name1, name2};
 
 DHT dhts[SENSOR_COUNT] = {
   DHT(dhtPins[0], DHT11),
@@ -16,51 +48,122 @@ DHT dhts[SENSOR_COUNT] = {
   DHT(dhtPins[2], DHT11)
 };
 
+// --- Framing ---
+uint8_t frame[FRAME_MAX_PAYLOAD];
+uint8_t frameLen = 0;
+uint8_t frameSeq = 0;
+
+void frameBegin(uint8_t type) {
+  frame[0] = type;
+  frame[1] = frameSeq++;
+  frameLen = 2;
+}
+
+void framePut(uint8_t b) {
+  if (frameLen < FRAME_MAX_PAYLOAD - 2) frame[frameLen++] = b;
+}
+
+void framePut16(uint16_t v) {
+  framePut(v & 0xFF);
+  framePut(v >> 8);
+}
+
+// Copies a flash string into the body, truncated to what fits.
+void framePutP(PGM_P s) {
+  char c;
+  while ((c = pgm_read_byte(s++)) != 0) framePut(c);
+}
+
+// Appends the CRC, COBS-encodes in place as it writes and sends the frame.
+void frameSend() {
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < frameLen; i++) crc = _crc_xmodem_update(crc, frame[i]);
+  frame[frameLen++] = crc & 0xFF;
+  frame[frameLen++] = crc >> 8;
+
+  // Each run of non-zero bytes goes out behind a code byte giving its
+  // length + 1; the zero that ended it is implied.
+  uint8_t start = 0;
+  for (uint8_t i = 0; i <= frameLen; i++) {
+    if (i == frameLen || frame[i] == 0) {
+      Serial.write((uint8_t)(i - start + 1));
+      Serial.write(frame + start, i - start);
+      start = i + 1;
+    }
+  }
+  Serial.write((uint8_t)0);
+}
+
+void sendLog(PGM_P text) {
+  frameBegin(FRAME_LOG);
+  framePutP(text);
+  frameSend();
+}
+
+void sendHello() {
+  frameBegin(FRAME_HELLO);
+  framePut(FRAME_VERSION);
+  framePut(SENSOR_COUNT);
+  framePut16(R3_INTERVAL_MS / 1000);
+  frameSend();
+}
+
+void sendNames() {
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    frameBegin(FRAME_NAME);
+    framePut(i);
+    framePutP((PGM_P)pgm_read_ptr(&sensorNames[i]));
+    frameSend();
+  }
+}
+
 void setup() {
   Serial.begin(115200);
-  delay(500);
-  Serial.println("[BOOT] Elegoo Uno R3 Sensor Node Starting...");
-
-  for (int i = 0; i < SENSOR_COUNT; i++) {
-    Serial.print("[INIT] Starting DHT sensor '");
-    Serial.print(sensorNames[i]);
-    Serial.print("' on Pin ");
-    Serial.println(dhtPins[i]);
-    dhts[i].begin();
-  }
+  Serial.write((uint8_t)0);  // ends whatever the bridge caught of the last run
+  sendLog(PSTR("[BOOT] Elegoo Uno R3 Sensor Node Starting..."));
+  sendHello();
+  sendNames();
+
+  for (int i = 0; i < SENSOR_COUNT; i++) dhts[i].begin();
 }
 
 void loop() {
-  Serial.println("\n--- Reading Sensors ---");
+  static unsigned long lastCycle = 0;
+  static uint16_t cycles = 0;
+  static bool first = true;
 
-  for (int i = 0; i < SENSOR_COUNT; i++) {
-    Serial.print("[");
-    Serial.print(sensorNames[i]);
-    Serial.println("] Reading data...");
+  unsigned long now = millis();
+  if (!first && now - lastCycle < R3_INTERVAL_MS) return;
+  first = false;
+  lastCycle = now;
 
+  if (++cycles % R3_NAMES_EVERY == 0) {
+    sendHello();
+    sendNames();
+  }
+
+  uint8_t sent = 0;
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
     float tempC = dhts[i].readTemperature();
     float humidity = dhts[i].readHumidity();
 
     if (isnan(tempC) || isnan(humidity)) {
-      Serial.print("[");
-      Serial.print(sensorNames[i]);
-      Serial.println("] Failed to read from DHT sensor!");
+      frameBegin(FRAME_FAULT);
+      framePut(i);
+      frameSend();
       continue;
     }
 
     float tempF = tempC * 1.8 + 32;
-
-    // Print as a simple line for server to pick up
-    Serial.print("sensor:");
-    Serial.print(sensorNames[i]);
-    Serial.print(",temp:");
-    Serial.print(tempF, 1);
-    Serial.print(",humidity:");
-    Serial.println(humidity, 1);
-    
-    delay(250); // Small gap between sensors
+    frameBegin(FRAME_READING);
+    framePut(i);
+    framePut16((int16_t)lroundf(tempF * 10));
+    framePut16((uint16_t)lroundf(humidity * 10));
+    frameSend();
+    sent++;
   }
 
-  Serial.println("--- Loop complete. Waiting 10 seconds ---\n");
-  delay(10000); // Main delay
+  frameBegin(FRAME_CYCLE);
+  framePut(sent);
+  frameSend();
 }
@@ -1,62 +1,492 @@
-import serial
-import requests
+"""Bridge the Uno R3 node's serial frames to the Frog API.
+
+ArudinoR3.cpp sends COBS frames, each ended by a 0x00:
+
+    COBS( type:u8 seq:u8 body... crc:u16le ) 0x00
+
+with a CRC-16/CCITT-FALSE over type, seq and body. The reader never waits
+on a line: it takes whatever bytes the port has, splits them on 0x00 and
+decodes each frame. A frame that fails COBS or the CRC is counted and
+dropped, and the next 0x00 puts the parser back in step. Readings are
+collected until the node's end-of-cycle frame.
+
+Reading the port and posting run on separate threads joined by a bounded
+queue. The uploader posts over one keep-alive session, merges whatever is
+queued into one batch, and backs off when the server fails. Readings it
+cannot deliver go to a spool file and are sent once the server is back.
+
+    python3 SerialToServer.py [--port /dev/ttyACM0] [--url ...] [--spool ...] [-v]
+"""
+
+import argparse
+import binascii
+import collections
+import itertools
+import json
+import os
+import queue
+import random
+import struct
+import threading
 import time
 
+import requests
+
 # === CONFIG ===
 serial_port = "/dev/ttyACM0"
 baud_rate = 115200
 server_url = "http://localhost:5020/frogtank/api/sensor"
+spool_path = "serial_spool.jsonl"
+stats_every = 60  # seconds
+queue_depth = 64  # batches between the reader and the uploader
+batch_max = 48  # readings per POST
+spool_max = 100000  # readings; about 3 days of the Uno's
+spool_compact = 1 << 20  # bytes of sent readings before the spool file is rewritten
+post_timeout = 10  # seconds
+backoff_min = 1  # seconds, doubling per failed post
+backoff_max = 60
 
-# === SETUP SERIAL ===
-ser = serial.Serial(serial_port, baud_rate, timeout=1)
-time.sleep(2)  # Give time for Arduino reset
+# Frame types, as in ArudinoR3.cpp.
+FRAME_HELLO = 0x01
+FRAME_NAME = 0x02
+FRAME_READING = 0x03
+FRAME_FAULT = 0x04
+FRAME_CYCLE = 0x05
+FRAME_LOG = 0x06
 
-print("Listening on", serial_port)
+FRAME_VERSION = 1
+MAX_FRAME = 256  # encoded; anything longer is noise
 
-while True:
-    try:
-        line = ser.readline().decode('utf-8').strip()
-        if line:
-            print("Received:", line)
+_hello = struct.Struct("<BBH")
+_reading = struct.Struct("<BhH")
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if code == 0 or pos + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[pos + 1:pos + code]
+        pos += code
+        if code < 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16(data):
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+class FrameDecoder:
+    """Turns a byte stream into (type, seq, body) frames.
+
+    feed() takes any number of bytes and returns the frames they completed.
+    Bad frames are dropped and counted in stats.
+    """
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.synced = False  # errors before the first good frame are start-up noise
+        self.last_seq = None
+        self.stats = dict(frames=0, bytes=0, crc=0, cobs=0, short=0, oversize=0, lost=0)
+
+    def feed(self, data):
+        self.stats["bytes"] += len(data)
+        frames = []
+        start = 0
+        while True:
+            end = data.find(b"\x00", start)
+            if end < 0:
+                self.buf += data[start:]
+                if len(self.buf) > MAX_FRAME:
+                    self._bad("oversize")
+                    self.buf.clear()
+                return frames
+            self.buf += data[start:end]
+            start = end + 1
+            encoded = bytes(self.buf)
+            self.buf.clear()
+            if encoded:
+                frame = self._decode(encoded)
+                if frame:
+                    frames.append(frame)
+
+    def _decode(self, encoded):
+        try:
+            payload = cobs_decode(encoded)
+        except ValueError:
+            return self._bad("cobs")
+        if len(payload) < 4:
+            return self._bad("short")
+        body, crc = payload[:-2], payload[-2] | payload[-1] << 8
+        if crc16(body) != crc:
+            return self._bad("crc")
+        seq = body[1]
+        self.synced = True
+        if self.last_seq is not None:
+            self.stats["lost"] += (seq - self.last_seq - 1) & 0xFF
+        self.last_seq = seq
+        self.stats["frames"] += 1
+        return body[0], seq, body[2:]
+
+    def _bad(self, kind):
+        if self.synced:
+            self.stats[kind] += 1
+        return None
+
+
+class Node:
+    """What the bridge knows about the Uno: sensor names and the cycle so far."""
+
+    def __init__(self, verbose=False):
+        self.names = {}
+        self.pending = []
+        self.faults = 0
+        self.unnamed = 0
+        self.verbose = verbose
+
+    def handle(self, ftype, body):
+        """Returns a batch to post when the frame ends a cycle, else None."""
+        if ftype == FRAME_READING:
+            index, temp, humidity = _reading.unpack_from(body)
+            name = self.names.get(index)
+            if name is None:
+                self.unnamed += 1
+                return None
+            # Stamped on arrival, so a reading that waits in the spool is
+            # still logged at the time it was taken.
+            self.pending.append({"sensor": name, "ts": int(time.time()), "temp": temp / 10,
+                                 "humidity": humidity / 10})
+        elif ftype == FRAME_CYCLE:
+            batch, self.pending = self.pending, []
+            return batch or None
+        elif ftype == FRAME_FAULT:
+            self.faults += 1
+            print("[%s] Failed to read from DHT sensor!" % self.names.get(body[0], "sensor %d" % body[0]))
+        elif ftype == FRAME_NAME:
+            self.names[body[0]] = body[1:].decode("utf-8", "replace")
+        elif ftype == FRAME_HELLO:
+            version, count, interval = _hello.unpack_from(body)
+            if version != FRAME_VERSION:
+                print("❗ Node speaks frame version %d, expected %d" % (version, FRAME_VERSION))
+            if self.verbose:
+                print("[HELLO] %d sensors every %d s" % (count, interval))
+        elif ftype == FRAME_LOG:
+            print(body.decode("utf-8", "replace"))
+        return None
+
+
+# --- Spool ---
+
+class Spool:
+    """Readings the server has not taken yet, one JSON object per line.
+
+    Lives on disk so a server outage (or a bridge restart during one) loses
+    nothing. Only the uploader thread touches it. Past `limit` readings the
+    oldest are dropped.
+
+    The readings are also held in memory, so draining never reads the file.
+    New readings are appended to it; sent ones are skipped by a byte offset
+    kept in `<path>.pos`. The file is rewritten without them only once they
+    outweigh what is left (and at least spool_compact bytes), or emptied
+    when the spool drains. A crash between the two writes replays readings
+    rather than losing them.
+    """
+
+    def __init__(self, path, limit):
+        self.path = path
+        self.pos_path = path + ".pos"
+        self.limit = limit
+        self.dropped = 0
+        self.readings = collections.deque()  # (reading, bytes of its line)
+        self.offset = 0  # bytes of the file already sent
+        self.size = 0  # bytes of the file still to send
+        self._load()
+        if len(self.readings) > limit:
+            self.dropped += len(self.readings) - limit
+            self.pop(len(self.readings) - limit)
+
+    @property
+    def count(self):
+        return len(self.readings)
 
-            # Only process lines that start with "sensor:"
-            if not line.startswith("sensor:"):
+    def append(self, readings):
+        lines = [json.dumps(r, separators=(",", ":")) + "\n" for r in readings]
+        with open(self.path, "a") as f:
+            f.writelines(lines)
+        self._extend(readings, lines)
+        if len(self.readings) > self.limit:
+            self.dropped += len(self.readings) - self.limit
+            self.pop(len(self.readings) - self.limit)
+
+    def peek(self, n):
+        return [r for r, _ in itertools.islice(self.readings, n)]
+
+    def pop(self, n):
+        for _ in range(min(n, len(self.readings))):
+            size = self.readings.popleft()[1]
+            self.offset += size
+            self.size -= size
+        if not self.readings or (self.offset >= spool_compact and self.offset > self.size):
+            self._compact()
+        else:
+            self._save_offset()
+
+    def _load(self):
+        try:
+            with open(self.pos_path) as f:
+                self.offset = int(f.read())
+        except (FileNotFoundError, ValueError):
+            self.offset = 0
+        try:
+            with open(self.path, "rb") as f:
+                data = f.read()
+        except FileNotFoundError:
+            data = b""
+        if self.offset > len(data):
+            self.offset = 0
+        clean = True
+        for line in data[self.offset:].splitlines(keepends=True):
+            try:
+                self.readings.append((json.loads(line), len(line)))
+                self.size += len(line)
+                clean = clean and line.endswith(b"\n")
+            except ValueError:
+                clean = False  # a line cut short by a crash
+        if self.offset or not clean:
+            self._compact()
+
+    def _compact(self):
+        # Offset first: a crash before the rewrite replays, never skips
+        self.offset = 0
+        self._save_offset()
+        readings = [r for r, _ in self.readings]
+        lines = [json.dumps(r, separators=(",", ":")) + "\n" for r in readings]
+        tmp = self.path + ".tmp"
+        with open(tmp, "w") as f:
+            f.writelines(lines)
+        os.replace(tmp, self.path)
+        self.readings.clear()
+        self.size = 0
+        self._extend(readings, lines)
+
+    def _extend(self, readings, lines):
+        for r, line in zip(readings, lines):
+            size = len(line.encode())
+            self.readings.append((r, size))
+            self.size += size
+
+    def _save_offset(self):
+        with open(self.pos_path, "w") as f:
+            f.write(str(self.offset))
+
+
+# --- Stages ---
+#
+#   serial -> reader -> queue (bounded) -> uploader -> Session -> /api/sensor
+#                                              \-> spool (disk) while the server is down
+#
+# The reader only decodes frames and never waits on the network, so a slow
+# server cannot back up the serial buffer. When the queue is full the
+# oldest batch is dropped and counted.
+
+class Metrics:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.c = dict(read=0, queued_drop=0, posts=0, posted=0, failed=0, rejected=0, spooled=0,
+                      post_ms=0.0, post_ms_max=0.0, queue_max=0)
+
+    def add(self, **kw):
+        with self.lock:
+            for k, v in kw.items():
+                self.c[k] += v
+
+    def peak(self, key, v):
+        with self.lock:
+            self.c[key] = max(self.c[key], v)
+
+    def take(self):
+        with self.lock:
+            c, self.c = self.c, dict.fromkeys(self.c, 0)
+        return c
+
+
+class Reader(threading.Thread):
+    def __init__(self, open_port, out, metrics, stop, verbose=False):
+        super().__init__(name="reader", daemon=True)
+        self.open_port = open_port
+        self.out = out
+        self.metrics = metrics
+        self.stop = stop
+        self.verbose = verbose
+        self.decoder = FrameDecoder()
+        self.node = Node(verbose)
+
+    def run(self):
+        ser = None
+        while not self.stop.is_set():
+            try:
+                if ser is None:
+                    ser = self.open_port()
+                data = ser.read(ser.in_waiting or 1)
+            except Exception as e:  # unplugged, or not there yet
+                print("[SERIAL] Error:", e)
+                ser = None
+                self.stop.wait(2)
+                continue
+            for ftype, seq, body in self.decoder.feed(data):
+                if self.verbose:
+                    print("[FRAME] type %d seq %d %s" % (ftype, seq, body.hex()))
+                try:
+                    batch = self.node.handle(ftype, body)
+                except (struct.error, IndexError):
+                    continue  # a frame too short for its type
+                if batch:
+                    self.push(batch)
+
+    def push(self, batch):
+        self.metrics.add(read=len(batch))
+        while True:
+            try:
+                self.out.put_nowait(batch)
+                break
+            except queue.Full:
+                try:
+                    dropped = self.out.get_nowait()
+                    self.metrics.add(queued_drop=len(dropped))
+                except queue.Empty:
+                    pass
+        self.metrics.peak("queue_max", self.out.qsize())
+
+
+class Uploader(threading.Thread):
+    def __init__(self, url, inbox, spool, metrics, stop):
+        super().__init__(name="uploader", daemon=True)
+        self.url = url
+        self.inbox = inbox
+        self.spool = spool
+        self.metrics = metrics
+        self.stop = stop
+        self.session = requests.Session()  # keep-alive across posts
+        self.backoff = 0.0
+        self.retry_at = 0.0
+
+    def run(self):
+        while not self.stop.is_set():
+            readings = self.gather()
+            if readings and (time.monotonic() < self.retry_at or not self.post(readings)):
+                self.spool.append(readings)
+                self.metrics.add(spooled=len(readings))
                 continue
+            if self.spool.count and time.monotonic() >= self.retry_at:
+                # The server is (probably) up: one chunk per turn, so live
+                # readings still go first.
+                chunk = self.spool.peek(batch_max)
+                if self.post(chunk):
+                    self.spool.pop(len(chunk))
+        # Shutting down: keep whatever is still queued.
+        rest = self.gather(wait=False)
+        if rest:
+            self.spool.append(rest)
 
-            # Parse sensor line
-            parts = line.split(",")
-            sensor_name = None
-            temp = None
-            humidity = None
-
-            for part in parts:
-                if part.startswith("sensor:"):
-                    sensor_name = part.split("sensor:")[1]
-                elif part.startswith("temp:"):
-                    temp = float(part.split("temp:")[1])
-                elif part.startswith("humidity:"):
-                    humidity = float(part.split("humidity:")[1])
-
-            if sensor_name and temp is not None and humidity is not None:
-                payload = {
-                    "sensor": sensor_name,
-                    "temp": temp,
-                    "humidity": humidity
-                }
-
-                print("Posting payload:", payload)
-
-                response = requests.post(server_url, json=payload)
-
-                if response.status_code == 200:
-                    print("✅ Data sent successfully.")
-                else:
-                    print("❌ Failed to send:", response.status_code, response.text)
+    def gather(self, wait=True):
+        """Up to batch_max readings: the next batch, plus any queued behind it."""
+        readings = []
+        try:
+            readings += self.inbox.get(timeout=0.5) if wait else self.inbox.get_nowait()
+            while len(readings) < batch_max:
+                readings += self.inbox.get_nowait()
+        except queue.Empty:
+            pass
+        return readings
+
+    def post(self, readings):
+        """True once the server has the readings (or refused them for good)."""
+        start = time.monotonic()
+        try:
+            response = self.session.post(self.url, json=readings, timeout=post_timeout)
+            status = response.status_code
+        except requests.RequestException as e:
+            print("[UPLOAD] ❌ %s" % e.__class__.__name__)
+            status = None
+        ms = (time.monotonic() - start) * 1000
+        self.metrics.add(posts=1, post_ms=ms)
+        self.metrics.peak("post_ms_max", ms)
+
+        if status is not None and status < 500 and status not in (408, 429):
+            self.backoff = 0.0
+            self.retry_at = 0.0
+            if status == 200:
+                self.metrics.add(posted=len(readings))
             else:
-                print("❗ Incomplete data:", line)
+                # Retrying will not change the server's mind.
+                print("[UPLOAD] ❌ Rejected:", status, response.text[:200])
+                self.metrics.add(rejected=len(readings))
+            return True
+
+        self.backoff = min(max(self.backoff * 2, backoff_min), backoff_max)
+        self.retry_at = time.monotonic() + self.backoff * random.uniform(0.8, 1.2)
+        self.metrics.add(failed=1)
+        if status is not None:
+            print("[UPLOAD] ❌ Failed to send:", status)
+        return False
+
+
+def report(metrics, inbox, reader, uploader, seconds):
+    c = metrics.take()
+    s = reader.decoder.stats
+    print("[SERIAL] frames %d (%d B), crc %d, cobs %d, short %d, oversize %d, lost %d, "
+          "faults %d, unnamed %d" % (s["frames"], s["bytes"], s["crc"], s["cobs"], s["short"],
+                                     s["oversize"], s["lost"], reader.node.faults, reader.node.unnamed))
+    print("[UPLOAD] %.2f readings/s in, %d posted in %d posts (%.0f ms avg, %.0f max), %d failed, "
+          "%d rejected, queue %d (max %d, %d dropped), spooled %d, spool %d (%d dropped)" % (
+              c["read"] / seconds, c["posted"], c["posts"], c["post_ms"] / max(c["posts"], 1),
+              c["post_ms_max"], c["failed"], c["rejected"], inbox.qsize(), c["queue_max"],
+              c["queued_drop"], c["spooled"], uploader.spool.count, uploader.spool.dropped))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--port", default=serial_port)
+    ap.add_argument("--baud", type=int, default=baud_rate)
+    ap.add_argument("--url", default=server_url)
+    ap.add_argument("--spool", default=spool_path, help="file for readings the server has not taken")
+    ap.add_argument("-v", "--verbose", action="store_true", help="print every frame")
+    args = ap.parse_args()
+
+    import serial
+
+    def open_port():
+        # A short timeout: read() returns whatever has arrived instead of
+        # waiting for a whole line.
+        ser = serial.Serial(args.port, args.baud, timeout=0.05)
+        time.sleep(2)  # Give time for Arduino reset
+        print("Listening on", args.port)
+        return ser
+
+    stop = threading.Event()
+    metrics = Metrics()
+    inbox = queue.Queue(maxsize=queue_depth)
+    spool = Spool(args.spool, spool_max)
+    if spool.count:
+        print("[UPLOAD] %d spooled readings from last run" % spool.count)
+    reader = Reader(open_port, inbox, metrics, stop, args.verbose)
+    uploader = Uploader(args.url, inbox, spool, metrics, stop)
+    reader.start()
+    uploader.start()
+
+    try:
+        while True:
+            time.sleep(stats_every)
+            report(metrics, inbox, reader, uploader, stats_every)
+    except KeyboardInterrupt:
+        stop.set()
+        reader.join()
+        uploader.join()
+        print("[UPLOAD] stopped, %d readings in the spool" % spool.count)
 
-        time.sleep(0.5)
 
-    except Exception as e:
-        print("Error:", e)
-        time.sleep(2)
+if __name__ == "__main__":
+    main()
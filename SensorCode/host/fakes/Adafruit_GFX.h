@@ -0,0 +1,133 @@
+#pragma once
+
+// Adafruit_GFX text and rectangle drawing, down to drawPixel()/fillRect()
+// like the real library. Glyphs come from a made-up 5x8 font (bits derived
+// from the character code): the shapes are wrong but every character
+// touches the same pixels the real one would, which is what the panel
+// fakes measure.
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : _rawWidth(w), _rawHeight(h), _width(w), _height(h) {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t j = y; j < y + h; j++)
+      for (int16_t i = x; i < x + w; i++) drawPixel(i, j, color);
+  }
+  virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+  }
+
+  virtual void drawRGBBitmap(int16_t x, int16_t y, const uint16_t* bitmap, int16_t w, int16_t h) {
+    for (int16_t j = 0; j < h; j++)
+      for (int16_t i = 0; i < w; i++) drawPixel(x + i, y + j, bitmap[j * w + i]);
+  }
+
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    for (int8_t col = 0; col < 6; col++) {
+      uint8_t bits = col < 5 ? glyphColumn(c, col) : 0;
+      for (int8_t row = 0; row < 8; row++, bits >>= 1) {
+        bool on = bits & 1;
+        if (!on && bg == color) continue;  // transparent background
+        uint16_t px = on ? color : bg;
+        if (size == 1) {
+          drawPixel(x + col, y + row, px);
+        } else {
+          fillRect(x + col * size, y + row * size, size, size, px);
+        }
+      }
+    }
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      _cursorX = 0;
+      _cursorY += _textSize * 8;
+    } else if (c != '\r') {
+      if (_wrap && _cursorX + _textSize * 6 > _width) {
+        _cursorX = 0;
+        _cursorY += _textSize * 8;
+      }
+      drawChar(_cursorX, _cursorY, c, _textColor, _textBg, _textSize);
+      _cursorX += _textSize * 6;
+    }
+    return 1;
+  }
+  using Print::write;
+
+  void getTextBounds(const char* s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    *x1 = x;
+    *y1 = y;
+    *w = strlen(s) * 6 * _textSize;
+    *h = 8 * _textSize;
+  }
+
+  void setCursor(int16_t x, int16_t y) {
+    _cursorX = x;
+    _cursorY = y;
+  }
+  int16_t getCursorX() const { return _cursorX; }
+  int16_t getCursorY() const { return _cursorY; }
+  void setTextColor(uint16_t c) { _textColor = _textBg = c; }
+  void setTextColor(uint16_t c, uint16_t bg) {
+    _textColor = c;
+    _textBg = bg;
+  }
+  void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+  void setTextWrap(bool w) { _wrap = w; }
+  void setFont(const void*) {}
+  void setRotation(uint8_t r) {
+    _rotation = r & 3;
+    _width = (_rotation & 1) ? _rawHeight : _rawWidth;
+    _height = (_rotation & 1) ? _rawWidth : _rawHeight;
+  }
+  uint8_t getRotation() const { return _rotation; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+protected:
+  static uint8_t glyphColumn(unsigned char c, int8_t col) {
+    if (c == ' ') return 0;
+    uint32_t h = (c * 2654435761u) ^ (col * 40503u);
+    return (uint8_t)(h >> 13) | 0x01;
+  }
+
+  int16_t _rawWidth, _rawHeight;
+  int16_t _width, _height;
+  int16_t _cursorX = 0, _cursorY = 0;
+  uint16_t _textColor = 0xFFFF, _textBg = 0xFFFF;
+  uint8_t _textSize = 1;
+  uint8_t _rotation = 0;
+  bool _wrap = true;
+};
+
+// Off-screen 16-bit canvas, as in the real library.
+class GFXcanvas16 : public Adafruit_GFX {
+public:
+  GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+    _buffer = (uint16_t*)calloc((size_t)w * h, sizeof(uint16_t));
+  }
+  ~GFXcanvas16() { free(_buffer); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    _buffer[x + y * _rawWidth] = color;
+  }
+  void fillScreen(uint16_t color) override {
+    for (size_t i = 0; i < (size_t)_rawWidth * _rawHeight; i++) _buffer[i] = color;
+  }
+  uint16_t* getBuffer() const { return _buffer; }
+
+private:
+  uint16_t* _buffer;
+};
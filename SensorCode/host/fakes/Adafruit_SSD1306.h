@@ -0,0 +1,56 @@
+#pragma once
+
+// SSD1306 over I2C. Drawing only touches the 1 KB framebuffer; display()
+// pushes the whole buffer, which is what FrogSim::displayBytes counts
+// (data plus the I2C control byte per 32-byte chunk and the address
+// commands), like Adafruit_SSD1306::display(). Data written to the panel
+// directly over Wire is counted by the Wire fake.
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC 0x01
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst = -1)
+      : Adafruit_GFX(w, h) {
+    _buffer = (uint8_t*)calloc((size_t)w * ((h + 7) / 8), 1);
+  }
+  ~Adafruit_SSD1306() override { free(_buffer); }
+
+  bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0, bool reset = true, bool periphBegin = true) {
+    FrogSim::get().displayBytes += 26;  // init command sequence
+    return true;
+  }
+
+  void clearDisplay() { memset(_buffer, 0, bufferSize()); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t* b = &_buffer[x + (y / 8) * _rawWidth];
+    uint8_t bit = 1 << (y & 7);
+    if (color == SSD1306_WHITE) *b |= bit;
+    else if (color == SSD1306_BLACK) *b &= ~bit;
+    else *b ^= bit;
+  }
+
+  void display() {
+    size_t n = bufferSize();
+    FrogSim::get().displayBytes += n + (n + 31) / 32 + 6;
+  }
+
+  void ssd1306_command(uint8_t) { FrogSim::get().displayBytes += 2; }  // control byte + command
+  void dim(bool) {}
+  void invertDisplay(bool) { FrogSim::get().displayBytes += 2; }
+  uint8_t* getBuffer() { return _buffer; }
+
+private:
+  size_t bufferSize() const { return (size_t)_rawWidth * ((_rawHeight + 7) / 8); }
+
+  uint8_t* _buffer;
+};
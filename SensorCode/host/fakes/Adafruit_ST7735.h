@@ -0,0 +1,64 @@
+#pragma once
+
+// ST7735 over SPI. There is no framebuffer: every fillRect() sets an
+// address window and streams 2 bytes per pixel, every lone drawPixel()
+// pays the window setup too. Those bytes go to FrogSim::displayBytes.
+
+#include <Adafruit_GFX.h>
+#include <SPI.h>
+
+#define INITR_GREENTAB 0x00
+#define INITR_REDTAB 0x01
+#define INITR_BLACKTAB 0x02
+#define INITR_144GREENTAB 0x01
+#define INITR_MINI160x80 0x04
+#define INITR_HALLOWING 0x05
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+#define ST77XX_RED 0xF800
+#define ST77XX_GREEN 0x07E0
+#define ST77XX_BLUE 0x001F
+#define ST77XX_CYAN 0x07FF
+#define ST77XX_MAGENTA 0xF81F
+#define ST77XX_YELLOW 0xFFE0
+#define ST77XX_ORANGE 0xFC00
+
+class Adafruit_ST7735 : public Adafruit_GFX {
+public:
+  Adafruit_ST7735(int8_t cs, int8_t dc, int8_t rst) : Adafruit_GFX(128, 160) {}
+
+  void initR(uint8_t options = INITR_GREENTAB) {
+    if (options == INITR_MINI160x80) {
+      _rawWidth = 80;
+      _rawHeight = 160;
+      setRotation(_rotation);
+    }
+    FrogSim::get().displayBytes += 60;  // init command list
+  }
+  void setSPISpeed(uint32_t) {}
+  void invertDisplay(bool) { FrogSim::get().displayBytes += 1; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    FrogSim::get().displayBytes += kWindowBytes + 2;
+  }
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if (w <= 0 || h <= 0) return;
+    FrogSim::get().displayBytes += kWindowBytes + (uint32_t)w * h * 2;
+  }
+
+  // One address window for the whole bitmap, like Adafruit_SPITFT.
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t* bitmap, int16_t w, int16_t h) override {
+    if (x < 0 || y < 0 || x + w > _width || y + h > _height || w <= 0 || h <= 0) return;
+    FrogSim::get().displayBytes += kWindowBytes + (uint32_t)w * h * 2;
+  }
+
+private:
+  static const uint32_t kWindowBytes = 11;  // CASET + RASET + RAMWR
+};
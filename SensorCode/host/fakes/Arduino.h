@@ -0,0 +1,206 @@
+#pragma once
+
+// --- Host Arduino core ---
+// Just enough of the Arduino/ESP core for the FrogNode sketches to build
+// and run on Linux. Time is virtual: millis()/micros() only move when the
+// simulator ticks or the firmware calls delay(), so runs are repeatable.
+// Everything the simulator measures lives in FrogSim (sim.h).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+#include "sim.h"
+
+using std::isnan;
+using std::isinf;
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// RTC memory is its own section, which the simulator carries over a
+// simulated deep sleep.
+#define IRAM_ATTR
+#define RTC_DATA_ATTR __attribute__((section("frog_rtc")))
+#define RTC_NOINIT_ATTR __attribute__((section("frog_rtc")))
+#define PROGMEM
+#define F(s) (s)
+
+// Wemos D1 pin names (ESP8266 GPIO numbers)
+#if defined(ESP8266)
+static const uint8_t D0 = 16;
+static const uint8_t D1 = 5;
+static const uint8_t D2 = 4;
+static const uint8_t D3 = 0;
+static const uint8_t D4 = 2;
+static const uint8_t D5 = 14;
+static const uint8_t D6 = 12;
+static const uint8_t D7 = 13;
+static const uint8_t D8 = 15;
+#endif
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+int8_t digitalPinToAnalogChannel(uint8_t pin);  // ESP32 layout: ADC1 0-7, ADC2 10+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeoutUs = 1000000UL);
+
+// Handlers run at the virtual time of their edge, from inside whatever
+// call advanced the clock past it (see FrogSim::advanceUs).
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterruptArg(uint8_t pin, void (*fn)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+// --- String ---
+// Heap-backed like the real one, so String-heavy code shows up in the
+// allocation counts.
+class String {
+public:
+  String(const char* s = "") { assign(s ? s : "", s ? strlen(s) : 0); }
+  String(const String& o) { assign(o.c_str(), o._len); }
+  explicit String(char c) { assign(&c, 1); }
+  String(int v) { char t[16]; snprintf(t, sizeof(t), "%d", v); assign(t, strlen(t)); }
+  String(unsigned v) { char t[16]; snprintf(t, sizeof(t), "%u", v); assign(t, strlen(t)); }
+  String(long v) { char t[24]; snprintf(t, sizeof(t), "%ld", v); assign(t, strlen(t)); }
+  String(unsigned long v) { char t[24]; snprintf(t, sizeof(t), "%lu", v); assign(t, strlen(t)); }
+  String(float v, unsigned char decimals = 2) { char t[40]; snprintf(t, sizeof(t), "%.*f", decimals, v); assign(t, strlen(t)); }
+  String(double v, unsigned char decimals = 2) { char t[40]; snprintf(t, sizeof(t), "%.*f", decimals, v); assign(t, strlen(t)); }
+  ~String() { free(_buf); }
+
+  String& operator=(const String& o) {
+    if (this != &o) assign(o.c_str(), o._len);
+    return *this;
+  }
+  String& operator+=(const String& o) { return concat(o.c_str(), o._len); }
+  String& operator+=(const char* s) { return concat(s, strlen(s)); }
+  String& operator+=(char c) { return concat(&c, 1); }
+
+  friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+  friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+  friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+
+  bool operator==(const char* s) const { return strcmp(c_str(), s) == 0; }
+  const char* c_str() const { return _buf ? _buf : ""; }
+  unsigned int length() const { return _len; }
+  int toInt() const { return atoi(c_str()); }
+  float toFloat() const { return (float)atof(c_str()); }
+
+private:
+  void assign(const char* s, size_t n) {
+    _len = 0;
+    concat(s, n);
+  }
+  String& concat(const char* s, size_t n) {
+    char* p = (char*)realloc(_buf, _len + n + 1);
+    if (!p) return *this;
+    _buf = p;
+    memcpy(_buf + _len, s, n);
+    _len += n;
+    _buf[_len] = '\0';
+    return *this;
+  }
+
+  char* _buf = nullptr;
+  size_t _len = 0;
+};
+
+// --- Print / Stream ---
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t k = 0;
+    while (n--) k += write(*buf++);
+    return k;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int decimals = 2) { return printf("%.*f", decimals, v); }
+
+  size_t println() { return write("\r\n"); }
+  template <class T>
+  size_t println(const T& v) { return print(v) + println(); }
+  size_t println(double v, int decimals) { return print(v, decimals) + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char tmp[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write((const uint8_t*)tmp, (size_t)n < sizeof(tmp) ? n : sizeof(tmp) - 1);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+};
+
+// Serial goes to stdout unless the simulator was started with --quiet.
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override {
+    FrogSim::get().serialBytes += n;
+    if (!FrogSim::get().quiet) fwrite(buf, 1, n, stdout);
+    return n;
+  }
+  using Print::write;
+  void flush() { fflush(stdout); }
+  operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  void restart() { FrogSim::get().restart(); }
+  uint32_t getFreeHeap() { return 200000; }
+
+  // ESP8266: 512 bytes of RTC user memory, addressed in 4-byte blocks.
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+  void deepSleep(uint64_t us) { FrogSim::get().deepSleep(us); }
+};
+extern EspClass ESP;
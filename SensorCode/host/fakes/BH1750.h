@@ -0,0 +1,31 @@
+#pragma once
+
+// BH1750 on the fake I2C bus: lux follows a 12-minute "day" so the display
+// dimming and deadband code see both light and dark.
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class BH1750 {
+public:
+  enum Mode {
+    UNCONFIGURED = 0,
+    CONTINUOUS_HIGH_RES_MODE = 0x10,
+    CONTINUOUS_HIGH_RES_MODE_2 = 0x11,
+    CONTINUOUS_LOW_RES_MODE = 0x13,
+    ONE_TIME_HIGH_RES_MODE = 0x20,
+    ONE_TIME_HIGH_RES_MODE_2 = 0x21,
+    ONE_TIME_LOW_RES_MODE = 0x23
+  };
+
+  BH1750(byte addr = 0x23) : _addr(addr) {}
+  bool begin(Mode mode = CONTINUOUS_HIGH_RES_MODE, byte addr = 0x23, TwoWire* i2c = nullptr) {
+    if (addr) _addr = addr;
+    return true;
+  }
+  float readLightLevel();
+  byte address() const { return _addr; }
+
+private:
+  byte _addr;
+};
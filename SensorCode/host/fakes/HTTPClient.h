@@ -0,0 +1,49 @@
+#pragma once
+
+// Minimal HTTP/1.1 client over the fake WiFiClient: one request at a time,
+// Content-Length bodies only, keep-alive when setReuse(true). Error codes
+// match the ESP cores' HTTPClient.
+
+#include <WiFi.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient& client, const char* host, uint16_t port, const char* uri = "/", bool https = false);
+  bool begin(WiFiClient& client, const String& host, uint16_t port, const String& uri = "/", bool https = false) {
+    return begin(client, host.c_str(), port, uri.c_str(), https);
+  }
+  void setReuse(bool reuse) { _reuse = reuse; }
+  void setTimeout(uint16_t ms) { _timeoutMs = ms; }
+  void addHeader(const String& name, const String& value);
+
+  int POST(const uint8_t* payload, size_t size);
+  int POST(uint8_t* payload, size_t size) { return POST((const uint8_t*)payload, size); }
+  int POST(const String& payload) { return POST((const uint8_t*)payload.c_str(), payload.length()); }
+  int GET() { return request("GET", nullptr, 0); }
+
+  String getString() { return String(_body); }
+  int getSize() { return (int)_bodyLen; }
+  void end();
+
+private:
+  int request(const char* method, const uint8_t* payload, size_t size);
+  bool readLine(char* line, size_t cap);
+
+  WiFiClient* _client = nullptr;
+  char _host[64] = "";
+  char _uri[128] = "/";
+  uint16_t _port = 80;
+  char _headers[256] = "";
+  bool _reuse = false;
+  bool _serverClose = false;
+  uint16_t _timeoutMs = 5000;
+  char _body[512] = "";
+  size_t _bodyLen = 0;
+};
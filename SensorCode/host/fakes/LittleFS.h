@@ -0,0 +1,38 @@
+#pragma once
+
+// LittleFS backed by a directory on the host (FROG_SIM_FS, default
+// ./littlefs under the simulator's working directory).
+
+#include <Arduino.h>
+
+class File : public Stream {
+public:
+  File(FILE* f = nullptr) : _f(f) {}
+  explicit operator bool() const { return _f != nullptr; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override { return _f ? fwrite(buf, 1, n, _f) : 0; }
+  using Print::write;
+  size_t read(uint8_t* buf, size_t n) { return _f ? fread(buf, 1, n, _f) : 0; }
+  int read() override { return _f ? fgetc(_f) : -1; }
+  int available() override;
+  bool seek(uint32_t pos) { return _f && fseek(_f, pos, SEEK_SET) == 0; }
+  size_t position() const { return _f ? ftell(_f) : 0; }
+  size_t size() const;
+  void flush() { if (_f) fflush(_f); }
+  void close() {
+    if (_f) fclose(_f);
+    _f = nullptr;
+  }
+
+private:
+  FILE* _f;
+};
+
+class FS {
+public:
+  bool begin();
+  bool exists(const char* path);
+  bool remove(const char* path);
+  File open(const char* path, const char* mode);
+};
+extern FS LittleFS;
@@ -0,0 +1,23 @@
+#pragma once
+
+// ESP8266 core Ticker, one-shot only, on the simulator's virtual clock
+// (see SimTimer in sim.h).
+
+#include <Arduino.h>
+
+class Ticker {
+public:
+  template <typename TArg>
+  void once_ms(uint32_t milliseconds, void (*callback)(TArg), TArg arg) {
+    static_assert(sizeof(TArg) <= sizeof(void*), "Ticker arg must fit in a pointer");
+    _sim.fn = reinterpret_cast<void (*)(void*)>(callback);
+    _sim.arg = (void*)arg;
+    simTimerStart(_sim, (uint64_t)milliseconds * 1000);
+  }
+
+  void detach() { simTimerStop(_sim); }
+  bool active() const { return _sim.atUs != 0; }
+
+private:
+  SimTimer _sim;
+};
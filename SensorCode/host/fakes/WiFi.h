@@ -0,0 +1,86 @@
+#pragma once
+
+// Simulated station mode. WiFi.status() follows FrogSim's join delay and
+// outage window. WiFiClient is a real TCP socket; every connect() goes to
+// the simulator's stub server whatever host the firmware asked for.
+
+#include <Arduino.h>
+
+#define WL_IDLE_STATUS 0
+#define WL_NO_SSID_AVAIL 1
+#define WL_CONNECTED 3
+#define WL_CONNECT_FAILED 4
+#define WL_DISCONNECTED 6
+
+#define WIFI_STA 1
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _b{a, b, c, d} {}
+  String toString() const {
+    char t[16];
+    snprintf(t, sizeof(t), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]);
+    return String(t);
+  }
+  operator String() const { return toString(); }
+
+private:
+  uint8_t _b[4];
+};
+
+class WiFiClass {
+public:
+  int begin(const char* ssid, const char* pass = nullptr, int32_t channel = 0,
+            const uint8_t* bssid = nullptr, bool connect = true) {
+    FrogSim::get().wifiBeganAtUs = (int64_t)FrogSim::get().nowUs;
+    FrogSim::get().wifiFastJoin = channel != 0 && bssid != nullptr;
+    return WL_DISCONNECTED;
+  }
+  bool disconnect(bool wifiOff = false, bool eraseAp = false) {
+    FrogSim::get().wifiBeganAtUs = -1;
+    return true;
+  }
+  int status() { return FrogSim::get().wifiUp() ? WL_CONNECTED : WL_DISCONNECTED; }
+  bool isConnected() { return status() == WL_CONNECTED; }
+  bool mode(int) { return true; }
+  void persistent(bool) {}
+  bool setAutoReconnect(bool) { return true; }
+  IPAddress localIP() { return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress(); }
+  int32_t RSSI() { return status() == WL_CONNECTED ? -58 : 0; }
+  int32_t channel() { return 6; }
+  uint8_t* BSSID() { return _bssid; }
+
+private:
+  uint8_t _bssid[6] = {0x02, 0x46, 0x52, 0x4F, 0x47, 0x01};
+};
+extern WiFiClass WiFi;
+
+class WiFiClient : public Stream {
+public:
+  WiFiClient() {}
+  ~WiFiClient() override { stop(); }
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+
+  virtual int connect(const char* host, uint16_t port);
+  virtual uint8_t connected();
+  virtual void stop();
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t n);
+  int peek() override;
+  void setTimeout(unsigned long ms) { _timeoutMs = ms; }
+
+protected:
+  bool fill(bool wait);
+
+  int _fd = -1;
+  uint8_t _rx[1024];
+  size_t _rxPos = 0;
+  size_t _rxLen = 0;
+  unsigned long _timeoutMs = 5000;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+// No TLS on the host: the stub server speaks plain HTTP. The secure client
+// only keeps the calls the firmware makes on the real one.
+
+#include <WiFi.h>
+
+namespace BearSSL {
+class Session {};
+}
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+  void setSession(BearSSL::Session*) {}
+  void setCACert(const char*) {}
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Bytes written to an SSD1306 address (0x3C/0x3D) count as display bytes.
+class TwoWire : public Stream {
+public:
+  bool begin() { return true; }
+  bool begin(int sda, int scl, uint32_t frequency = 0) { return true; }
+  void setClock(uint32_t hz) { _hz = hz; }
+  uint32_t getClock() const { return _hz; }
+  void beginTransmission(uint8_t addr) { _addr = addr; }
+  uint8_t endTransmission(bool stop = true) { return 0; }
+  uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+  size_t write(uint8_t) override {
+    if (_addr == 0x3C || _addr == 0x3D) FrogSim::get().displayBytes++;
+    return 1;
+  }
+  using Print::write;
+
+private:
+  uint32_t _hz = 100000;
+  uint8_t _addr = 0;
+};
+extern TwoWire Wire;
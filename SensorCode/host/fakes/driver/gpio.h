@@ -0,0 +1,15 @@
+#pragma once
+
+// ESP-IDF GPIO calls FrogDht uses to drive a DHT line next to an RMT
+// receiver. Levels go through the same pin model as digitalWrite().
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+typedef int gpio_num_t;
+typedef enum { GPIO_MODE_INPUT, GPIO_MODE_OUTPUT, GPIO_MODE_INPUT_OUTPUT_OD } gpio_mode_t;
+typedef enum { GPIO_PULLUP_ONLY, GPIO_PULLDOWN_ONLY, GPIO_PULLUP_PULLDOWN, GPIO_FLOATING } gpio_pull_mode_t;
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);  // sim_core.cpp
+inline esp_err_t gpio_set_direction(gpio_num_t, gpio_mode_t) { return ESP_OK; }
+inline esp_err_t gpio_set_pull_mode(gpio_num_t, gpio_pull_mode_t) { return ESP_OK; }
@@ -0,0 +1,57 @@
+#pragma once
+
+// ESP-IDF RMT receive channel. A channel armed with rmt_receive() records
+// what the simulated device on its pin sends once the host releases the
+// line (gpio_set_level(pin, 1)), and on_recv_done fires when the line has
+// been idle for signal_range_max_ns, all on the virtual clock.
+
+#include <driver/gpio.h>
+
+#define SOC_RMT_MEM_WORDS_PER_CHANNEL 48
+#define SOC_RMT_RX_CHANNELS 4
+
+typedef enum { RMT_CLK_SRC_DEFAULT } rmt_clock_source_t;
+
+typedef union {
+  struct {
+    uint16_t duration0 : 15;
+    uint16_t level0 : 1;
+    uint16_t duration1 : 15;
+    uint16_t level1 : 1;
+  };
+  uint32_t val;
+} rmt_symbol_word_t;
+
+struct rmt_channel_t;
+typedef rmt_channel_t* rmt_channel_handle_t;
+
+typedef struct {
+  rmt_symbol_word_t* received_symbols;
+  size_t num_symbols;
+} rmt_rx_done_event_data_t;
+
+typedef bool (*rmt_rx_done_callback_t)(rmt_channel_handle_t, const rmt_rx_done_event_data_t*, void*);
+
+typedef struct {
+  rmt_rx_done_callback_t on_recv_done;
+} rmt_rx_event_callbacks_t;
+
+typedef struct {
+  gpio_num_t gpio_num;
+  rmt_clock_source_t clk_src;
+  uint32_t resolution_hz;
+  size_t mem_block_symbols;
+  int intr_priority;
+} rmt_rx_channel_config_t;
+
+typedef struct {
+  uint32_t signal_range_min_ns;
+  uint32_t signal_range_max_ns;
+} rmt_receive_config_t;
+
+// sim_core.cpp
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t* cfg, rmt_channel_handle_t* out);
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t ch, const rmt_rx_event_callbacks_t* cbs, void* user);
+esp_err_t rmt_enable(rmt_channel_handle_t ch);
+esp_err_t rmt_disable(rmt_channel_handle_t ch);
+esp_err_t rmt_receive(rmt_channel_handle_t ch, void* buf, size_t size, const rmt_receive_config_t* cfg);
@@ -0,0 +1,117 @@
+#pragma once
+
+// ESP-IDF continuous ADC driver. Conversions "happen" at sample_freq_hz on
+// the virtual clock from adc_continuous_start(); adc_continuous_read()
+// returns what the DMA would have stored by now, up to max_store_buf_size,
+// in the TYPE2 layout (4 bytes per result). The codes come from the same
+// noisy model as analogRead() (sim_core.cpp).
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+#define SOC_ADC_DIGI_RESULT_BYTES 4
+#define SOC_ADC_DIGI_MAX_BITWIDTH 12
+#define SOC_ADC_PATT_LEN_MAX 24
+#define SOC_ADC_CHANNEL_NUM(unit) ((unit) == 0 ? 8 : 10)
+
+typedef enum { ADC_UNIT_1, ADC_UNIT_2 } adc_unit_t;
+typedef enum { ADC_ATTEN_DB_0, ADC_ATTEN_DB_2_5, ADC_ATTEN_DB_6, ADC_ATTEN_DB_12 } adc_atten_t;
+typedef enum { ADC_CONV_SINGLE_UNIT_1 = 1, ADC_CONV_SINGLE_UNIT_2, ADC_CONV_BOTH_UNIT, ADC_CONV_ALTER_UNIT } adc_digi_convert_mode_t;
+typedef enum { ADC_DIGI_OUTPUT_FORMAT_TYPE1, ADC_DIGI_OUTPUT_FORMAT_TYPE2 } adc_digi_output_format_t;
+
+typedef struct {
+  uint8_t atten;
+  uint8_t channel;
+  uint8_t unit;
+  uint8_t bit_width;
+} adc_digi_pattern_config_t;
+
+typedef struct {
+  uint32_t max_store_buf_size;
+  uint32_t conv_frame_size;
+} adc_continuous_handle_cfg_t;
+
+typedef struct {
+  uint32_t pattern_num;
+  adc_digi_pattern_config_t* adc_pattern;
+  uint32_t sample_freq_hz;
+  adc_digi_convert_mode_t conv_mode;
+  adc_digi_output_format_t format;
+} adc_continuous_config_t;
+
+typedef struct {
+  union {
+    struct {
+      uint16_t data : 12;
+      uint16_t channel : 4;
+    } type1;
+    struct {
+      uint32_t data : 12;
+      uint32_t reserved12 : 1;
+      uint32_t channel : 4;
+      uint32_t unit : 1;
+      uint32_t reserved17_31 : 14;
+    } type2;
+    uint32_t val;
+  };
+} adc_digi_output_data_t;
+
+struct adc_continuous_ctx_t {
+  uint32_t storeBytes;
+  uint32_t freqHz;
+  uint8_t channels[SOC_ADC_PATT_LEN_MAX];
+  uint32_t patternNum;
+  bool running;
+  uint64_t startUs;
+  uint64_t produced;  // conversions handed out since start
+};
+typedef adc_continuous_ctx_t* adc_continuous_handle_t;
+
+int simAdcSample(uint8_t channel);  // sim_core.cpp
+
+inline esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t* cfg, adc_continuous_handle_t* out) {
+  *out = new adc_continuous_ctx_t{};
+  (*out)->storeBytes = cfg->max_store_buf_size;
+  return ESP_OK;
+}
+
+inline esp_err_t adc_continuous_config(adc_continuous_handle_t h, const adc_continuous_config_t* cfg) {
+  if (h->running || cfg->pattern_num == 0 || cfg->pattern_num > SOC_ADC_PATT_LEN_MAX) return ESP_ERR_INVALID_STATE;
+  h->freqHz = cfg->sample_freq_hz;
+  h->patternNum = cfg->pattern_num;
+  for (uint32_t i = 0; i < cfg->pattern_num; i++) h->channels[i] = cfg->adc_pattern[i].channel;
+  return ESP_OK;
+}
+
+inline esp_err_t adc_continuous_start(adc_continuous_handle_t h) {
+  if (h->running) return ESP_ERR_INVALID_STATE;
+  h->running = true;
+  h->startUs = FrogSim::get().nowUs;
+  h->produced = 0;
+  return ESP_OK;
+}
+
+inline esp_err_t adc_continuous_stop(adc_continuous_handle_t h) {
+  if (!h->running) return ESP_ERR_INVALID_STATE;
+  h->running = false;
+  return ESP_OK;
+}
+
+inline esp_err_t adc_continuous_read(adc_continuous_handle_t h, uint8_t* buf, uint32_t len, uint32_t* got,
+                                     uint32_t) {
+  *got = 0;
+  if (!h->running) return ESP_ERR_INVALID_STATE;
+  uint64_t converted = (FrogSim::get().nowUs - h->startUs) * h->freqHz / 1000000ULL;
+  uint64_t stored = h->storeBytes / SOC_ADC_DIGI_RESULT_BYTES;  // the pool drops the rest
+  if (converted > stored) converted = stored;
+  while (h->produced < converted && *got + SOC_ADC_DIGI_RESULT_BYTES <= len) {
+    uint8_t channel = h->channels[h->produced % h->patternNum];
+    adc_digi_output_data_t d = {};
+    d.type2.channel = channel;
+    d.type2.data = (uint32_t)simAdcSample(channel);
+    memcpy(buf + *got, &d, sizeof(d));
+    *got += SOC_ADC_DIGI_RESULT_BYTES;
+    h->produced++;
+  }
+  return *got ? ESP_OK : ESP_ERR_TIMEOUT;
+}
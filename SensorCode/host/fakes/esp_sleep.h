@@ -0,0 +1,11 @@
+#pragma once
+
+// ESP-IDF deep sleep: the simulator restarts the sketch after the timer.
+
+#include <Arduino.h>
+
+inline uint64_t simSleepTimerUs = 0;
+
+inline void esp_sleep_enable_timer_wakeup(uint64_t us) { simSleepTimerUs = us; }
+inline void esp_deep_sleep_start() { FrogSim::get().deepSleep(simSleepTimerUs); }
+inline void esp_deep_sleep(uint64_t us) { FrogSim::get().deepSleep(us); }
@@ -0,0 +1,41 @@
+#pragma once
+
+// ESP-IDF one-shot high-resolution timer, on the simulator's virtual clock
+// (see SimTimer in sim.h).
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct esp_timer {
+  SimTimer sim;
+};
+typedef esp_timer* esp_timer_handle_t;
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  esp_timer* t = new esp_timer();
+  t->sim.fn = args->callback;
+  t->sim.arg = args->arg;
+  *out = t;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs) {
+  simTimerStart(t->sim, timeoutUs);
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  simTimerStop(t->sim);
+  return ESP_OK;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// FreeRTOS types and macros for the one pinned task FrogNode creates. The
+// tick is 1 ms, as in the Arduino ESP32 core.
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef struct SimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define configTICK_RATE_HZ 1000
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
@@ -0,0 +1,16 @@
+#pragma once
+
+// Tasks on the other core. The simulator has one thread, so a pinned task
+// runs on its own stack in between loop() passes (sim_core.cpp): it is
+// resumed once it has been notified or its timeout is up, and runs until
+// it blocks again. Its work is therefore never charged to a loop() pass,
+// as on the chip.
+
+#include <freertos/FreeRTOS.h>
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackBytes, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xPortGetCoreID();
@@ -0,0 +1,87 @@
+#pragma once
+
+// --- FrogSim ---
+// State shared by the host fakes: the virtual clock, the simulated Wi-Fi
+// and the counters the simulator reports. Set up from the command line in
+// sim_core.cpp; the fakes only read and bump it.
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct FrogSim {
+  // --- Clock ---
+  uint64_t nowUs = 0;                 // virtual time since the run started
+  uint64_t bootAtUs = 0;              // last boot or deep-sleep wake; millis() counts from here
+  uint32_t epochBase = 1760000000UL;  // wall clock at boot, once SNTP "syncs"
+  int64_t clockSyncedAtUs = -1;       // set by configTime(), -1 = never
+
+  // --- Network ---
+  const char* serverHost = "127.0.0.1";  // every connect() goes here
+  uint16_t serverPort = 8765;
+  uint32_t wifiJoinMs = 1500;            // from WiFi.begin() to WL_CONNECTED
+  uint32_t wifiFastJoinMs = 300;         // same, when given the AP's channel and BSSID
+  bool wifiFastJoin = false;
+  uint32_t outageFromMs = 0;             // Wi-Fi is down in [from, to)
+  uint32_t outageToMs = 0;
+  int64_t wifiBeganAtUs = -1;
+
+  // --- Sensors ---
+  uint32_t dhtFailEvery = 0;  // every Nth DHT read fails (0 = never)
+
+  // --- Output ---
+  bool quiet = false;  // swallow Serial
+
+  // --- Counters ---
+  uint64_t allocs = 0;
+  uint64_t allocBytes = 0;
+  uint64_t bytesSent = 0;
+  uint64_t bytesReceived = 0;
+  uint64_t connects = 0;
+  uint64_t displayBytes = 0;  // bytes that would go over SPI/I2C to a panel
+  uint64_t serialBytes = 0;
+
+  bool wifiUp() const {
+    if (wifiBeganAtUs < 0) return false;
+    uint64_t ms = nowUs / 1000;
+    if (outageToMs > outageFromMs && ms >= outageFromMs && ms < outageToMs) return false;
+    uint32_t joinMs = wifiFastJoin ? wifiFastJoinMs : wifiJoinMs;
+    return nowUs - (uint64_t)wifiBeganAtUs >= (uint64_t)joinMs * 1000;
+  }
+
+  // --- Interrupts ---
+  uint64_t nextEdgeUs = UINT64_MAX;  // earliest pending pin edge or RMT event
+
+  // Events that fall inside the step fire at their own time, so micros()
+  // in a handler reads what it would on the chip.
+  void advanceUs(uint64_t us) {
+    uint64_t target = nowUs + us;
+    if (nextEdgeUs <= target) fireEdges(target);
+    nowUs = target;
+  }
+
+  void fireEdges(uint64_t untilUs);
+
+  void restart();
+  void deepSleep(uint64_t us);  // re-runs the sketch from setup(), RTC memory kept
+
+  static FrogSim& get();
+};
+
+// Constant-initialized, so the malloc hook can use it before any
+// constructor has run.
+extern FrogSim frogSim;
+
+inline FrogSim& FrogSim::get() { return frogSim; }
+
+// --- One-shot timers ---
+// The body behind the esp_timer and Ticker fakes. The callback runs at its
+// virtual time, from whatever call advances the clock past it, like a pin
+// interrupt. Starting an armed timer again moves it.
+struct SimTimer {
+  void (*fn)(void*) = nullptr;
+  void* arg = nullptr;
+  uint64_t atUs = 0;  // 0 = not armed
+};
+
+void simTimerStart(SimTimer& t, uint64_t us);  // sim_core.cpp
+inline void simTimerStop(SimTimer& t) { t.atUs = 0; }
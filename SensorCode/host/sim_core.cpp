@@ -0,0 +1,1004 @@
+// Host runtime for the FrogNode sketches: the bodies of the fakes in
+// fakes/, plus a main() that runs setup() and then loop() on a virtual
+// clock and reports what each loop() cost.
+//
+// Built together with one sketch by simulate.py; see the README for the
+// command line.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <LittleFS.h>
+#include <driver/rmt_rx.h>
+#include <freertos/task.h>
+#include <BH1750.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+TwoWire Wire;
+SPIClass SPI;
+FS LittleFS;
+
+FrogSim frogSim;
+static FrogSim& sim = frogSim;
+
+// --- Heap accounting ---
+// Every malloc/calloc/realloc (and so every new) bumps FrogSim::allocs.
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t n) {
+  sim.allocs++;
+  sim.allocBytes += n;
+  return __libc_malloc(n);
+}
+
+void* calloc(size_t n, size_t size) {
+  sim.allocs++;
+  sim.allocBytes += n * size;
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t n) {
+  sim.allocs++;
+  sim.allocBytes += n;
+  return __libc_realloc(p, n);
+}
+
+void free(void* p) {
+  __libc_free(p);
+}
+}
+
+// --- Clock ---
+
+unsigned long millis() { return (unsigned long)((sim.nowUs - sim.bootAtUs) / 1000); }
+unsigned long micros() { return (unsigned long)(sim.nowUs - sim.bootAtUs); }
+void delay(unsigned long ms) { sim.advanceUs((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { sim.advanceUs(us); }
+void yield() {}
+
+void configTime(long, int, const char*, const char*, const char*) {
+  sim.clockSyncedAtUs = (int64_t)sim.nowUs + 2000000;  // first SNTP answer
+}
+
+// Before SNTP has answered an ESP reports seconds since boot, after it the
+// simulated wall clock.
+extern "C" time_t time(time_t* out) __THROW {
+  time_t t = (time_t)((sim.nowUs - sim.bootAtUs) / 1000000);
+  if (sim.clockSyncedAtUs >= 0 && sim.nowUs >= (uint64_t)sim.clockSyncedAtUs) {
+    t = (time_t)(sim.epochBase + sim.nowUs / 1000000);
+  }
+  if (out) *out = t;
+  return t;
+}
+
+void FrogSim::restart() {
+  fprintf(stderr, "[SIM] ESP.restart() at %.3fs\n", nowUs / 1e6);
+  fflush(stdout);
+  exit(3);
+}
+
+// --- RTC memory ---
+// Everything in the frog_rtc section (RTC_NOINIT_ATTR / RTC_DATA_ATTR) is
+// saved across a simulated deep sleep, the ESP8266 user memory included.
+
+RTC_NOINIT_ATTR static uint32_t rtcUserMemory[128];
+extern "C" char __start_frog_rtc[];
+extern "C" char __stop_frog_rtc[];
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(rtcUserMemory)) return false;
+  memcpy(data, (uint8_t*)rtcUserMemory + offset * 4, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(rtcUserMemory)) return false;
+  memcpy((uint8_t*)rtcUserMemory + offset * 4, data, size);
+  return true;
+}
+
+// --- GPIO / ADC ---
+
+static double simSeconds() { return sim.nowUs / 1e6; }
+
+int digitalRead(uint8_t) { return LOW; }
+
+// A TDS probe around 1400 codes drifting slowly, with the ESP32 ADC's
+// conversion noise and the odd spike on top. The noise is a fixed
+// pseudo-random sequence, so runs repeat.
+static uint32_t adcNoiseState = 0x2545F491;
+
+static double adcNoise() {
+  double sum = 0;
+  for (int i = 0; i < 4; i++) {  // roughly Gaussian, sd about 1
+    adcNoiseState ^= adcNoiseState << 13;
+    adcNoiseState ^= adcNoiseState >> 17;
+    adcNoiseState ^= adcNoiseState << 5;
+    sum += (adcNoiseState & 0xFFFF) / 65535.0;
+  }
+  return (sum - 2.0) * 1.73;
+}
+
+int simAdcSample(uint8_t channel) {
+  double code = 1380 + (channel % 4) * 20 + 40 * sin(simSeconds() / 90.0 + channel) + 18 * adcNoise();
+  if ((adcNoiseState & 0x3F) == 0) code += 350;  // 1 in 64
+  return code < 0 ? 0 : (code > 4095 ? 4095 : (int)code);
+}
+
+int8_t digitalPinToAnalogChannel(uint8_t pin) {
+  static const int8_t adc1[] = {36, 37, 38, 39, 32, 33, 34, 35};
+  static const int8_t adc2[] = {4, 0, 2, 15, 13, 12, 14, 27, 25, 26};
+  for (int8_t i = 0; i < 8; i++) {
+    if (adc1[i] == pin) return i;
+  }
+  for (int8_t i = 0; i < 10; i++) {
+    if (adc2[i] == pin) return 10 + i;
+  }
+  return -1;
+}
+
+int analogRead(uint8_t pin) {
+  sim.advanceUs(10);
+  int8_t channel = digitalPinToAnalogChannel(pin);
+  return simAdcSample(channel < 0 ? pin : (uint8_t)channel);
+}
+
+// --- Pins and interrupts ---
+// Timed events (pin edges, RMT completions, one-shot timers) wait in a small table and run
+// from advanceUs() at their own virtual time.
+//
+// Two kinds of device answer on the pins:
+//   - An HC-SR04 on any pin with a handler: when a trigger pin goes low
+//     after a pulse, every attached echo pin gets a rising and a falling
+//     edge, the echo from a water surface 6 +/- 1.5 cm away. One ping in 16
+//     gets no echo and one in 8 bounces off the tank wall instead, so
+//     filtering has something to do. The pairing is loose (any trigger
+//     pings every echo pin), which is fine with one sonar per node.
+//   - A DHT on any pin that was held low and then released: either to a
+//     handler attached right after the release (pin interrupts) or to an
+//     armed RMT channel (gpio_set_level(pin, 1)).
+
+struct SimIsr {
+  uint8_t pin;
+  void (*fn)(void*);
+  void* arg;
+  bool dht;
+};
+
+struct SimEvent {
+  uint64_t atUs;
+  void (*fn)(void*);
+  void* arg;
+};
+
+static SimIsr isrs[8];
+static uint8_t isrCount = 0;
+static SimEvent events[512];
+static uint16_t eventCount = 0;
+static uint8_t pinLevel[64];
+static uint8_t pinModes[64];
+static uint64_t pinLowSinceUs[64];
+static uint64_t pinReleasedAtUs[64];  // DHT start pulse just ended
+static uint32_t pinStartUs[64];       // and how long it was
+static uint32_t echoNoiseState = 0x9E3779B9;
+
+static uint32_t echoNoise() {
+  echoNoiseState ^= echoNoiseState << 13;
+  echoNoiseState ^= echoNoiseState >> 17;
+  echoNoiseState ^= echoNoiseState << 5;
+  return echoNoiseState;
+}
+
+static void schedule(uint64_t atUs, void (*fn)(void*), void* arg) {
+  if (eventCount >= sizeof(events) / sizeof(events[0])) return;
+  events[eventCount++] = {atUs, fn, arg};
+  if (atUs < sim.nextEdgeUs) sim.nextEdgeUs = atUs;
+}
+
+void FrogSim::fireEdges(uint64_t untilUs) {
+  for (;;) {
+    int first = -1;
+    for (uint16_t i = 0; i < eventCount; i++) {
+      if (first < 0 || events[i].atUs < events[first].atUs) first = i;
+    }
+    if (first < 0 || events[first].atUs > untilUs) {
+      nextEdgeUs = first < 0 ? UINT64_MAX : events[first].atUs;
+      return;
+    }
+    SimEvent e = events[first];
+    events[first] = events[--eventCount];
+    nowUs = e.atUs;
+    e.fn(e.arg);
+  }
+}
+
+static void fireTimer(void* arg) {
+  SimTimer& t = *(SimTimer*)arg;
+  if (t.atUs != sim.nowUs || !t.fn) return;  // stopped or moved since
+  t.atUs = 0;
+  t.fn(t.arg);
+}
+
+void simTimerStart(SimTimer& t, uint64_t us) {
+  t.atUs = sim.nowUs + (us ? us : 1);
+  schedule(t.atUs, fireTimer, &t);
+}
+
+static void fireIsr(void* index) {
+  SimIsr& isr = isrs[(uintptr_t)index];
+  if (isr.fn) isr.fn(isr.arg);
+}
+
+// A DHT's answer to a start pulse, from the moment the host lets go: the
+// pull-up, the 80/80 µs response, 40 bits and the closing low, as
+// alternating levels starting high. Values are a slow sine per pin. A
+// start pulse of 10 ms or more means a DHT11 (whole numbers), shorter a
+// DHT22 (tenths). Every --dht-fail-every'th answer has a bit flipped, so
+// the checksum catches it. Returns the number of pulses.
+static uint16_t dhtAnswer(uint8_t pin, uint32_t startUs, uint16_t* us) {
+  static uint32_t answers = 0;
+  double phase = simSeconds() / 600.0 * 2 * M_PI + pin;
+  float tempC = 22.0f + pin % 5 + 0.8f * (float)sin(phase);
+  float humidity = 55.0f + pin % 7 + 3.0f * (float)cos(phase);
+  uint8_t b[5];
+  if (startUs >= 10000) {
+    b[0] = (uint8_t)roundf(humidity);
+    b[1] = 0;
+    b[2] = (uint8_t)roundf(tempC);
+    b[3] = 0;
+  } else {
+    uint16_t h = (uint16_t)roundf(humidity * 10);
+    uint16_t t = (uint16_t)roundf(tempC * 10);
+    b[0] = h >> 8;
+    b[1] = h & 0xFF;
+    b[2] = t >> 8;
+    b[3] = t & 0xFF;
+  }
+  b[4] = (uint8_t)(b[0] + b[1] + b[2] + b[3]);
+  answers++;
+  if (sim.dhtFailEvery && answers % sim.dhtFailEvery == 0) b[echoNoise() % 4] ^= 0x10;
+
+  uint16_t n = 0;
+  auto jitter = [](uint16_t base) { return (uint16_t)(base - 3 + echoNoise() % 7); };
+  us[n++] = jitter(30);  // pull-up, until the sensor answers
+  us[n++] = jitter(80);
+  us[n++] = jitter(80);
+  for (uint8_t i = 0; i < 40; i++) {
+    us[n++] = jitter(50);
+    us[n++] = jitter((b[i / 8] >> (7 - i % 8)) & 1 ? 70 : 27);
+  }
+  us[n++] = jitter(50);
+  return n;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= sizeof(pinModes)) return;
+  if (mode == INPUT_PULLUP && pinModes[pin] == OUTPUT && pinLevel[pin] == LOW) {
+    pinReleasedAtUs[pin] = sim.nowUs;
+    pinStartUs[pin] = (uint32_t)(sim.nowUs - pinLowSinceUs[pin]);
+  }
+  pinModes[pin] = mode;
+  if (mode != OUTPUT) pinLevel[pin] = HIGH;  // pulled up (or a sensor idling high)
+}
+
+void attachInterruptArg(uint8_t pin, void (*fn)(void*), void* arg, int) {
+  uint8_t i = 0;
+  while (i < isrCount && isrs[i].pin != pin) i++;
+  if (i == sizeof(isrs) / sizeof(isrs[0])) return;
+  if (i == isrCount) isrCount++;
+  bool dht = pin < sizeof(pinReleasedAtUs) / sizeof(pinReleasedAtUs[0]) &&
+             pinReleasedAtUs[pin] == sim.nowUs && pinStartUs[pin] > 0;
+  isrs[i] = {pin, fn, arg, dht};
+  if (!dht) return;
+  // Every pulse boundary is an edge.
+  uint16_t us[96];
+  uint16_t n = dhtAnswer(pin, pinStartUs[pin], us);
+  uint64_t at = sim.nowUs;
+  for (uint16_t p = 0; p < n; p++) {
+    at += us[p];
+    schedule(at, fireIsr, (void*)(uintptr_t)i);
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  for (uint8_t i = 0; i < isrCount; i++) {
+    if (isrs[i].pin == pin) isrs[i].fn = nullptr;
+  }
+}
+
+static void ping() {
+  for (uint8_t i = 0; i < isrCount; i++) {
+    if (isrs[i].dht || !isrs[i].fn) continue;
+    uint32_t r = echoNoise();
+    if ((r & 0xF) == 0) continue;  // lost
+    double cm = 6.0 + 1.5 * sin(simSeconds() / 300.0 + isrs[i].pin);
+    if ((r & 0x70) == 0) cm *= 0.5 + (r >> 24) / 255.0;  // the wall
+    uint64_t riseUs = sim.nowUs + 460;  // after the 40 kHz burst goes out
+    schedule(riseUs, fireIsr, (void*)(uintptr_t)i);
+    schedule(riseUs + (uint64_t)(cm * 2.0 / 0.0343), fireIsr, (void*)(uintptr_t)i);
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= sizeof(pinLevel)) return;
+  if (pinLevel[pin] == HIGH && val == LOW) {
+    pinLowSinceUs[pin] = sim.nowUs;
+    ping();
+  }
+  pinLevel[pin] = val;
+}
+
+// --- RMT receive ---
+
+struct rmt_channel_t {
+  uint8_t pin;
+  rmt_rx_done_callback_t done;
+  void* user;
+  rmt_symbol_word_t* buf;
+  size_t maxSymbols;
+  uint32_t idleUs;
+  uint32_t armed;  // bumped by every rmt_receive(); 0 = not listening
+  uint32_t pending;
+  size_t received;
+};
+
+static rmt_channel_t rmtChannels[SOC_RMT_RX_CHANNELS];
+static uint8_t rmtCount = 0;
+
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t* cfg, rmt_channel_handle_t* out) {
+  if (rmtCount >= SOC_RMT_RX_CHANNELS) return ESP_ERR_NOT_FOUND;
+  rmt_channel_t& ch = rmtChannels[rmtCount++];
+  ch = {};
+  ch.pin = (uint8_t)cfg->gpio_num;
+  *out = &ch;
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t ch, const rmt_rx_event_callbacks_t* cbs, void* user) {
+  ch->done = cbs->on_recv_done;
+  ch->user = user;
+  return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t) { return ESP_OK; }
+
+esp_err_t rmt_disable(rmt_channel_handle_t ch) {
+  ch->armed = 0;
+  return ESP_OK;
+}
+
+esp_err_t rmt_receive(rmt_channel_handle_t ch, void* buf, size_t size, const rmt_receive_config_t* cfg) {
+  static uint32_t seq = 0;
+  ch->buf = (rmt_symbol_word_t*)buf;
+  ch->maxSymbols = size / sizeof(rmt_symbol_word_t);
+  ch->idleUs = cfg->signal_range_max_ns / 1000;
+  ch->armed = ++seq;
+  return ESP_OK;
+}
+
+static void rmtDone(void* arg) {
+  rmt_channel_t& ch = *(rmt_channel_t*)arg;
+  if (ch.armed != ch.pending || !ch.done) return;  // disabled or re-armed since
+  ch.armed = 0;
+  rmt_rx_done_event_data_t e = {ch.buf, ch.received};
+  ch.done(&ch, &e, ch.user);
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+  if (pin < 0 || pin >= (int)sizeof(pinLevel)) return ESP_FAIL;
+  if (level == 0) {
+    if (pinLevel[pin] != LOW) pinLowSinceUs[pin] = sim.nowUs;
+    pinLevel[pin] = LOW;
+    return ESP_OK;
+  }
+  if (pinLevel[pin] == LOW) {
+    uint32_t startUs = (uint32_t)(sim.nowUs - pinLowSinceUs[pin]);
+    for (uint8_t i = 0; i < rmtCount; i++) {
+      rmt_channel_t& ch = rmtChannels[i];
+      if (ch.pin != pin || !ch.armed) continue;
+      uint16_t us[96];
+      uint16_t n = dhtAnswer((uint8_t)pin, startUs, us);
+      uint32_t total = 0;
+      size_t symbols = 0;
+      for (uint16_t p = 0; p < n && symbols < ch.maxSymbols; p += 2, symbols++) {
+        rmt_symbol_word_t& w = ch.buf[symbols];
+        w.level0 = 1;  // pulses alternate, starting high
+        w.duration0 = us[p];
+        w.level1 = 0;
+        w.duration1 = p + 1 < n ? us[p + 1] : 0;
+        total += us[p] + (p + 1 < n ? us[p + 1] : 0);
+      }
+      if (symbols < ch.maxSymbols) {  // the idle high that ended the frame
+        ch.buf[symbols] = {};
+        ch.buf[symbols++].level0 = 1;
+      }
+      ch.received = symbols;
+      ch.pending = ch.armed;
+      schedule(sim.nowUs + total + ch.idleUs, rmtDone, &ch);
+    }
+  }
+  pinLevel[pin] = HIGH;
+  return ESP_OK;
+}
+
+// Ultrasonic echo from a water surface 6 +/- 1.5 cm away. The call blocks
+// for the echo like the real pulseIn().
+unsigned long pulseIn(uint8_t pin, uint8_t, unsigned long timeoutUs) {
+  double cm = 6.0 + 1.5 * sin(simSeconds() / 300.0 + pin);
+  unsigned long us = (unsigned long)(cm * 2.0 / 0.0343);
+  if (us > timeoutUs) {
+    sim.advanceUs(timeoutUs);
+    return 0;
+  }
+  sim.advanceUs(us);
+  return us;
+}
+
+// --- BH1750 ---
+
+float BH1750::readLightLevel() {
+  sim.advanceUs(300);  // two bytes over I2C
+  double day = sin(simSeconds() / 720.0 * 2 * M_PI + _addr);
+  return day > 0 ? (float)(day * 400.0 + 2.5) : 2.5f;
+}
+
+// --- WiFiClient: a plain TCP socket to the stub server ---
+
+int WiFiClient::connect(const char*, uint16_t) {
+  stop();
+  if (!sim.wifiUp()) return 0;
+  char port[8];
+  snprintf(port, sizeof(port), "%u", sim.serverPort);
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(sim.serverHost, port, &hints, &res) != 0) return 0;
+  for (addrinfo* a = res; a; a = a->ai_next) {
+    int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0) continue;
+    if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      _fd = fd;
+      break;
+    }
+    close(fd);
+  }
+  freeaddrinfo(res);
+  if (_fd < 0) return 0;
+  sim.connects++;
+  _rxPos = _rxLen = 0;
+  return 1;
+}
+
+uint8_t WiFiClient::connected() {
+  if (_fd < 0) return 0;
+  if (_rxPos < _rxLen) return 1;
+  if (!sim.wifiUp()) {
+    stop();
+    return 0;
+  }
+  char c;
+  ssize_t n = recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiClient::stop() {
+  if (_fd >= 0) close(_fd);
+  _fd = -1;
+  _rxPos = _rxLen = 0;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t n) {
+  if (_fd < 0 || !sim.wifiUp()) return 0;
+  size_t sent = 0;
+  while (sent < n) {
+    ssize_t k = send(_fd, buf + sent, n - sent, MSG_NOSIGNAL);
+    if (k <= 0) break;
+    sent += k;
+  }
+  sim.bytesSent += sent;
+  return sent;
+}
+
+bool WiFiClient::fill(bool wait) {
+  if (_rxPos < _rxLen) return true;
+  if (_fd < 0) return false;
+  pollfd p = {_fd, POLLIN, 0};
+  if (poll(&p, 1, wait ? (int)_timeoutMs : 0) <= 0) return false;
+  ssize_t n = recv(_fd, _rx, sizeof(_rx), 0);
+  if (n <= 0) {
+    stop();
+    return false;
+  }
+  sim.bytesReceived += n;
+  _rxPos = 0;
+  _rxLen = n;
+  return true;
+}
+
+int WiFiClient::available() {
+  fill(false);
+  return (int)(_rxLen - _rxPos);
+}
+
+int WiFiClient::read() {
+  if (!fill(true)) return -1;
+  return _rx[_rxPos++];
+}
+
+int WiFiClient::read(uint8_t* buf, size_t n) {
+  size_t got = 0;
+  while (got < n && fill(got == 0)) {
+    size_t k = std::min(n - got, _rxLen - _rxPos);
+    memcpy(buf + got, _rx + _rxPos, k);
+    _rxPos += k;
+    got += k;
+  }
+  return (int)got;
+}
+
+int WiFiClient::peek() {
+  if (!fill(true)) return -1;
+  return _rx[_rxPos];
+}
+
+// --- HTTPClient ---
+
+bool HTTPClient::begin(WiFiClient& client, const char* host, uint16_t port, const char* uri, bool) {
+  _client = &client;
+  snprintf(_host, sizeof(_host), "%s", host);
+  snprintf(_uri, sizeof(_uri), "%s", uri);
+  _port = port;
+  _headers[0] = '\0';
+  _body[0] = '\0';
+  _bodyLen = 0;
+  return true;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+  size_t used = strlen(_headers);
+  snprintf(_headers + used, sizeof(_headers) - used, "%s: %s\r\n", name.c_str(), value.c_str());
+}
+
+int HTTPClient::POST(const uint8_t* payload, size_t size) {
+  return request("POST", payload, size);
+}
+
+int HTTPClient::request(const char* method, const uint8_t* payload, size_t size) {
+  if (!_client) return HTTPC_ERROR_NOT_CONNECTED;
+  if (!_client->connected() && !_client->connect(_host, _port)) return HTTPC_ERROR_CONNECTION_REFUSED;
+  _client->setTimeout(_timeoutMs);
+
+  char head[512];
+  int n = snprintf(head, sizeof(head),
+                   "%s %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: FrogSim\r\nConnection: %s\r\n%sContent-Length: %u\r\n\r\n",
+                   method, _uri, _host, _reuse ? "keep-alive" : "close", _headers, (unsigned)size);
+  if (_client->write((const uint8_t*)head, n) != (size_t)n) return HTTPC_ERROR_SEND_HEADER_FAILED;
+  if (size && _client->write(payload, size) != size) return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+
+  char line[256];
+  if (!readLine(line, sizeof(line))) return HTTPC_ERROR_CONNECTION_LOST;
+  int code = 0;
+  if (sscanf(line, "HTTP/%*s %d", &code) != 1) return HTTPC_ERROR_CONNECTION_LOST;
+
+  size_t length = 0;
+  _serverClose = !_reuse;
+  while (readLine(line, sizeof(line)) && line[0]) {
+    if (strncasecmp(line, "Content-Length:", 15) == 0) length = strtoul(line + 15, nullptr, 10);
+    if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close")) _serverClose = true;
+  }
+
+  size_t keep = std::min(length, sizeof(_body) - 1);
+  _bodyLen = _client->read((uint8_t*)_body, keep);
+  _body[_bodyLen] = '\0';
+  for (size_t i = keep; i < length && _client->read() >= 0; i++) {
+  }
+  return code;
+}
+
+bool HTTPClient::readLine(char* line, size_t cap) {
+  size_t n = 0;
+  for (;;) {
+    int c = _client->read();
+    if (c < 0) return false;
+    if (c == '\n') break;
+    if (c != '\r' && n + 1 < cap) line[n++] = (char)c;
+  }
+  line[n] = '\0';
+  return true;
+}
+
+void HTTPClient::end() {
+  if (_client && (!_reuse || _serverClose)) _client->stop();
+}
+
+// --- LittleFS ---
+
+static std::string fsRoot() {
+  const char* dir = getenv("FROG_SIM_FS");
+  return dir && *dir ? dir : "littlefs";
+}
+
+static std::string fsPath(const char* path) { return fsRoot() + path; }
+
+bool FS::begin() {
+  mkdir(fsRoot().c_str(), 0755);
+  return true;
+}
+
+bool FS::exists(const char* path) { return access(fsPath(path).c_str(), F_OK) == 0; }
+
+bool FS::remove(const char* path) { return ::remove(fsPath(path).c_str()) == 0; }
+
+File FS::open(const char* path, const char* mode) {
+  std::string m = mode;
+  if (m.find('b') == std::string::npos) m += 'b';
+  return File(fopen(fsPath(path).c_str(), m.c_str()));
+}
+
+int File::available() {
+  if (!_f) return 0;
+  return (int)(size() - position());
+}
+
+size_t File::size() const {
+  if (!_f) return 0;
+  struct stat st;
+  fflush(_f);
+  return fstat(fileno(_f), &st) == 0 ? st.st_size : 0;
+}
+
+// --- Simulator main ---
+// A simulated deep sleep re-runs this binary with --resume: sleep() writes
+// the clock, the counters and the frog_rtc section to a file and execs,
+// the new process reads them back and starts at setup() like a wake-up.
+
+void setup();
+void loop();
+
+using WallClock = std::chrono::steady_clock;
+
+// What one run has measured so far, across deep sleeps.
+struct SimRun {
+  uint64_t endUs = 0;
+  uint64_t loops = 0;
+  uint64_t maxAllocs = 0;
+  uint64_t allocs = 0;  // the counters below cover loop() only
+  uint64_t allocBytes = 0;
+  uint64_t sent = 0;
+  uint64_t received = 0;
+  uint64_t display = 0;
+  uint64_t awakeUs = 0;
+  uint32_t boots = 0;
+};
+
+static SimRun run;
+static std::vector<double> busyUs;
+static std::vector<char*> simArgs;  // argv, for the exec after a deep sleep
+static const char* statePath = nullptr;
+static const char* metricsPath = nullptr;
+static const char* label = "";
+
+// --- loop() accounting ---
+
+static struct {
+  uint64_t t, allocs, allocBytes, sent, received, display, serial;
+  WallClock::time_point wall;
+} pass;
+
+static void passBegin() {
+  pass = {sim.nowUs, sim.allocs, sim.allocBytes, sim.bytesSent,
+          sim.bytesReceived, sim.displayBytes, sim.serialBytes, WallClock::now()};
+}
+
+static void passEnd() {
+  auto wall = WallClock::now();
+  run.loops++;
+  run.allocs += sim.allocs - pass.allocs;
+  run.allocBytes += sim.allocBytes - pass.allocBytes;
+  run.sent += sim.bytesSent - pass.sent;
+  run.received += sim.bytesReceived - pass.received;
+  run.display += sim.displayBytes - pass.display;
+
+  // An idle pass (nothing due) touches none of these; anything else did work.
+  bool busy = sim.nowUs != pass.t || sim.allocs != pass.allocs || sim.bytesSent != pass.sent ||
+              sim.displayBytes != pass.display || sim.serialBytes != pass.serial;
+  if (busy) {
+    busyUs.push_back(std::chrono::duration<double, std::micro>(wall - pass.wall).count());
+    run.maxAllocs = std::max(run.maxAllocs, sim.allocs - pass.allocs);
+  }
+}
+
+static double percentile(std::vector<double>& v, double p) {
+  if (v.empty()) return 0;
+  size_t i = std::min(v.size() - 1, (size_t)(p / 100.0 * (v.size() - 1) + 0.5));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return v[i];
+}
+
+[[noreturn]] static void finish() {
+  run.awakeUs += sim.nowUs - sim.bootAtUs;
+  double meanUs = 0;
+  for (double v : busyUs) meanUs += v;
+  meanUs = busyUs.empty() ? 0 : meanUs / busyUs.size();
+  size_t busy = busyUs.size();
+  double p50 = percentile(busyUs, 50), p99 = percentile(busyUs, 99), maxUs = percentile(busyUs, 100);
+  uint64_t endUs = std::max(sim.nowUs, run.endUs);
+
+  char json[1024];
+  snprintf(json, sizeof(json),
+           "{\"sketch\":\"%s\",\"virtual_s\":%.1f,\"loops\":%llu,\"busy_loops\":%zu,"
+           "\"loop_us\":{\"mean\":%.1f,\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f},"
+           "\"allocs\":%llu,\"alloc_bytes\":%llu,\"max_allocs_per_loop\":%llu,"
+           "\"bytes_sent\":%llu,\"bytes_received\":%llu,\"connects\":%llu,"
+           "\"display_bytes\":%llu,\"boots\":%u,\"awake_pct\":%.1f}",
+           label, endUs / 1e6, (unsigned long long)run.loops, busy, meanUs, p50, p99, maxUs,
+           (unsigned long long)run.allocs, (unsigned long long)run.allocBytes,
+           (unsigned long long)run.maxAllocs, (unsigned long long)run.sent,
+           (unsigned long long)run.received, (unsigned long long)sim.connects,
+           (unsigned long long)run.display, run.boots, 100.0 * run.awakeUs / endUs);
+  fflush(stdout);
+  fprintf(stderr, "[SIM] %s\n", json);
+  if (metricsPath) {
+    FILE* f = fopen(metricsPath, "w");
+    if (f) {
+      fprintf(f, "%s\n", json);
+      fclose(f);
+    }
+  }
+  exit(0);
+}
+
+// --- Other core ---
+// A pinned task gets its own stack and is switched to with swapcontext()
+// between loop() passes. It runs until it blocks in ulTaskNotifyTake() or
+// vTaskDelay(). Its traffic and allocations still count towards the run,
+// but not towards any loop() pass.
+
+struct SimTask {
+  ucontext_t ctx;
+  TaskFunction_t fn;
+  void* arg;
+  uint64_t wakeAtUs;
+  uint32_t notified;
+  std::vector<char> stack;
+};
+
+static std::vector<SimTask*> simTasks;
+static SimTask* simCurrent = nullptr;
+static ucontext_t simMainCtx;
+
+static void simTaskEntry() {
+  simCurrent->fn(simCurrent->arg);
+  fprintf(stderr, "[SIM] a FreeRTOS task returned\n");
+  exit(1);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t stackBytes, void* arg,
+                                   UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  SimTask* t = new SimTask();
+  t->fn = fn;
+  t->arg = arg;
+  t->wakeAtUs = sim.nowUs;
+  t->stack.resize(std::max<uint32_t>(stackBytes, 64 * 1024));  // host frames are bigger
+  getcontext(&t->ctx);
+  t->ctx.uc_stack.ss_sp = t->stack.data();
+  t->ctx.uc_stack.ss_size = t->stack.size();
+  t->ctx.uc_link = nullptr;
+  makecontext(&t->ctx, simTaskEntry, 0);
+  simTasks.push_back(t);
+  if (handle) *handle = t;
+  return pdPASS;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  task->notified++;
+}
+
+static void simBlock(uint64_t untilUs) {
+  SimTask* t = simCurrent;
+  if (!t) {  // loop() itself: just let the time pass
+    if (untilUs > sim.nowUs) sim.advanceUs(untilUs - sim.nowUs);
+    return;
+  }
+  t->wakeAtUs = untilUs;
+  swapcontext(&t->ctx, &simMainCtx);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  SimTask* t = simCurrent;
+  if (t && !t->notified) simBlock(ticks == portMAX_DELAY ? UINT64_MAX : sim.nowUs + (uint64_t)ticks * 1000);
+  if (!t) return 0;
+  uint32_t n = t->notified;
+  t->notified = clearOnExit ? 0 : (n ? n - 1 : 0);
+  return n;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  simBlock(sim.nowUs + (uint64_t)ticks * 1000);
+}
+
+BaseType_t xPortGetCoreID() { return simCurrent ? 0 : 1; }
+
+// Give every task that is ready its turn.
+static void runTasks() {
+  for (SimTask* t : simTasks) {
+    if (!t->notified && sim.nowUs < t->wakeAtUs) continue;
+    uint64_t sent = sim.bytesSent, received = sim.bytesReceived;
+    uint64_t allocs = sim.allocs, allocBytes = sim.allocBytes;
+    simCurrent = t;
+    swapcontext(&simMainCtx, &t->ctx);
+    simCurrent = nullptr;
+    run.sent += sim.bytesSent - sent;
+    run.received += sim.bytesReceived - received;
+    run.allocs += sim.allocs - allocs;
+    run.allocBytes += sim.allocBytes - allocBytes;
+  }
+}
+
+// --- Deep sleep ---
+
+static bool writeState(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  size_t busy = busyUs.size();
+  size_t rtcSize = __stop_frog_rtc - __start_frog_rtc;
+  bool ok = fwrite(&sim, sizeof(sim), 1, f) == 1 && fwrite(&run, sizeof(run), 1, f) == 1 &&
+            fwrite(&busy, sizeof(busy), 1, f) == 1 &&
+            (busy == 0 || fwrite(busyUs.data(), sizeof(double), busy, f) == busy) &&
+            fwrite(&rtcSize, sizeof(rtcSize), 1, f) == 1 &&
+            fwrite(__start_frog_rtc, 1, rtcSize, f) == rtcSize;
+  return fclose(f) == 0 && ok;
+}
+
+static bool readState(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  // Settings come from the command line again; only the run's progress is restored.
+  const char* host = sim.serverHost;
+  size_t busy = 0, rtcSize = 0;
+  bool ok = fread(&sim, sizeof(sim), 1, f) == 1 && fread(&run, sizeof(run), 1, f) == 1 &&
+            fread(&busy, sizeof(busy), 1, f) == 1;
+  if (ok) {
+    busyUs.resize(busy);
+    ok = busy == 0 || fread(busyUs.data(), sizeof(double), busy, f) == busy;
+  }
+  ok = ok && fread(&rtcSize, sizeof(rtcSize), 1, f) == 1 &&
+       rtcSize == (size_t)(__stop_frog_rtc - __start_frog_rtc) &&
+       fread(__start_frog_rtc, 1, rtcSize, f) == rtcSize;
+  fclose(f);
+  sim.serverHost = host;
+  return ok;
+}
+
+void FrogSim::deepSleep(uint64_t us) {
+  fflush(stdout);
+  passEnd();  // the pass that went to sleep never returns from loop()
+  run.awakeUs += nowUs - bootAtUs;
+  nowUs += us;
+  if (nowUs >= run.endUs) {
+    bootAtUs = nowUs;  // asleep until the end: no awake time left to add
+    finish();
+  }
+  if (!writeState(statePath)) {
+    fprintf(stderr, "[SIM] cannot write %s: %s\n", statePath, strerror(errno));
+    exit(1);
+  }
+  execv("/proc/self/exe", simArgs.data());
+  fprintf(stderr, "[SIM] exec after deep sleep failed: %s\n", strerror(errno));
+  exit(1);
+}
+
+// The part of waking up that the chip does for us.
+static void wake() {
+  sim.bootAtUs = sim.nowUs;
+  sim.wifiBeganAtUs = -1;  // the radio was off
+  sim.clockSyncedAtUs = -1;
+  run.boots++;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [--seconds N] [--tick-ms N] [--host H] [--port P] [--quiet]\n"
+          "          [--wifi-join-ms N] [--outage FROM-TO] [--dht-fail-every N]\n"
+          "          [--metrics FILE] [--label NAME]\n",
+          argv0);
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  double seconds = 120;
+  uint32_t tickUs = 1000;
+  const char* resume = nullptr;
+  label = argv[0];
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    auto next = [&]() -> const char* {
+      if (i + 1 >= argc) usage(argv[0]);
+      return argv[++i];
+    };
+    if (a == "--seconds") seconds = atof(next());
+    else if (a == "--tick-ms") tickUs = (uint32_t)(atof(next()) * 1000);
+    else if (a == "--host") sim.serverHost = next();
+    else if (a == "--port") sim.serverPort = (uint16_t)atoi(next());
+    else if (a == "--quiet") sim.quiet = true;
+    else if (a == "--wifi-join-ms") sim.wifiJoinMs = (uint32_t)atoi(next());
+    else if (a == "--outage") {
+      double from = 0, to = 0;
+      if (sscanf(next(), "%lf-%lf", &from, &to) != 2) usage(argv[0]);
+      sim.outageFromMs = (uint32_t)(from * 1000);
+      sim.outageToMs = (uint32_t)(to * 1000);
+    } else if (a == "--dht-fail-every") sim.dhtFailEvery = (uint32_t)atoi(next());
+    else if (a == "--metrics") metricsPath = next();
+    else if (a == "--label") label = next();
+    else if (a == "--resume") resume = next();
+    else usage(argv[0]);
+  }
+  if (tickUs == 0) tickUs = 1;
+
+  static std::string state = fsRoot() + ".sleep";
+  statePath = state.c_str();
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--resume") == 0) {
+      i++;
+      continue;
+    }
+    simArgs.push_back(argv[i]);
+  }
+  simArgs.push_back((char*)"--resume");
+  simArgs.push_back((char*)statePath);
+  simArgs.push_back(nullptr);
+
+  if (resume) {
+    if (!readState(resume)) {
+      fprintf(stderr, "[SIM] cannot resume from %s\n", resume);
+      return 1;
+    }
+  } else {
+    run.endUs = (uint64_t)(seconds * 1e6);
+    busyUs.reserve(1 << 16);
+  }
+  wake();
+
+  setup();
+  while (sim.nowUs < run.endUs) {
+    passBegin();
+    loop();
+    passEnd();
+    runTasks();
+    sim.advanceUs(tickUs);
+  }
+  finish();
+}
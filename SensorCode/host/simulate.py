@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""Build the FrogNode sketches for Linux and run them against a stub server.
+
+Every sketch that includes <FrogNode.h> is preprocessed the way the Arduino
+builder does it (prototypes for functions used before they are defined),
+compiled with the fakes in fakes/ plus sim_core.cpp, and run for a fixed
+stretch of virtual time. A local HTTP server stands in for the Frog API
+and counts what arrives.
+
+    python3 SensorCode/host/simulate.py                  # all sketches, 120 s each
+    python3 SensorCode/host/simulate.py --sketch Office --seconds 600 -v
+    python3 SensorCode/host/simulate.py --outage 20-60 --json metrics.json
+    python3 SensorCode/host/simulate.py --delay-ms 300     # a slow server
+
+Exit status is non-zero if a sketch fails to build, crashes, or gets no
+readings through to the stub server, so it can run as a CI step.
+"""
+
+import argparse
+import http.server
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+HOST_DIR = os.path.dirname(os.path.abspath(__file__))
+SENSOR_DIR = os.path.dirname(HOST_DIR)
+FAKES_DIR = os.path.join(HOST_DIR, "fakes")
+LIB_DIR = os.path.join(SENSOR_DIR, "FrogNode")
+SIM_CORE = os.path.join(HOST_DIR, "sim_core.cpp")
+
+# The stub decodes binary batches with the server's own decoder.
+sys.path.insert(0, os.path.join(os.path.dirname(SENSOR_DIR), "frogApiApp"))
+import frogpack  # noqa: E402
+
+# Start of a top-level function definition: return type, name, arguments, "{".
+FUNC_RE = re.compile(r"^(?!static\b|if\b|for\b|while\b|switch\b|return\b|else\b)"
+                     r"([A-Za-z_][\w:<>\*&\s]*?[\s\*&])(\w+)\s*\(([^;{}()]*)\)\s*\{", re.M)
+
+
+# --- Stub server ---
+
+class StubStats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.reset()
+
+    def reset(self):
+        self.posts = 0
+        self.readings = 0
+        self.body_bytes = 0
+        self.bad = 0
+
+
+class StubHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive, like nginx in front of the API
+    disable_nagle_algorithm = True  # headers and body go out as separate writes
+    stats = StubStats()
+    status = 200
+    fail_every = 0
+    delay_s = 0.0
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length)
+        stats = self.stats
+        with stats.lock:
+            stats.posts += 1
+            stats.body_bytes += len(body)
+            n = stats.posts
+        try:
+            decoder = frogpack.DECODERS.get(self.headers.get("Content-Type", "").split(";")[0].strip())
+            data = decoder(body) if decoder else json.loads(body)
+            count = len(data) if isinstance(data, list) else 1
+        except ValueError:
+            count = 0
+            with stats.lock:
+                stats.bad += 1
+
+        if self.delay_s:
+            time.sleep(self.delay_s)  # a slow server: real time, so it lands in whichever pass waits on it
+        code = self.status
+        if self.fail_every and n % self.fail_every == 0:
+            code = 503
+        if code == 200:
+            with stats.lock:
+                stats.readings += count
+        reply = json.dumps({"status": "ok" if code == 200 else "error", "count": count}).encode()
+        self.send_response(code)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(reply)))
+        self.end_headers()
+        self.wfile.write(reply)
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def start_stub(port):
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", port), StubHandler)
+    server.daemon_threads = True
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+# --- Build ---
+
+def find_sketches(pattern):
+    found = []
+    for root, dirs, files in os.walk(SENSOR_DIR):
+        dirs[:] = [d for d in dirs if os.path.join(root, d) not in (HOST_DIR, LIB_DIR)]
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            try:
+                with open(path, encoding="utf-8", errors="replace") as f:
+                    text = f.read()
+            except OSError:
+                continue
+            if "#include <FrogNode.h>" in text and "void setup()" in text:
+                if not pattern or pattern.lower() in os.path.relpath(path, SENSOR_DIR).lower():
+                    found.append(path)
+    return sorted(found)
+
+
+def preprocess(path, out_path):
+    """Arduino-style: add prototypes ahead of the first function definition."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    protos = []
+    first = None
+    for m in FUNC_RE.finditer(text):
+        ret, name, args = m.group(1).strip(), m.group(2), m.group(3).strip()
+        if first is None:
+            first = m.start()
+        if name in ("setup", "loop"):
+            continue
+        args = re.sub(r"\s*=\s*[^,]+", "", args)  # default arguments stay on the definition
+        protos.append("%s %s(%s);" % (ret, name, args))
+    if first is None:
+        first = len(text)
+    line = text.count("\n", 0, first) + 1
+    src = ['#include <Arduino.h>', '#line 1 "%s"' % path, text[:first]]
+    src += protos
+    src += ['#line %d "%s"' % (line, path), text[first:]]
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write("\n".join(src))
+
+
+def build(path, build_dir, cxx):
+    name = os.path.relpath(path, SENSOR_DIR).replace(os.sep, "_").replace(".", "_")
+    src = os.path.join(build_dir, name + ".cpp")
+    exe = os.path.join(build_dir, name)
+    preprocess(path, src)
+    cmd = [cxx, "-std=gnu++17", "-O2", "-g", "-Wall", "-DFROG_SIM",
+           "-I", FAKES_DIR, "-I", LIB_DIR, src, SIM_CORE, "-o", exe]
+    if "8266" in os.path.basename(path):
+        cmd.insert(1, "-DESP8266")
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    return exe, result
+
+
+# --- Run ---
+
+def run(exe, label, args, port, build_dir, verbose):
+    fs_dir = exe + ".fs"
+    shutil.rmtree(fs_dir, ignore_errors=True)
+    cmd = [exe, "--seconds", str(args.seconds), "--port", str(port), "--label", label]
+    if args.outage:
+        cmd += ["--outage", args.outage]
+    if args.dht_fail_every:
+        cmd += ["--dht-fail-every", str(args.dht_fail_every)]
+    if not verbose:
+        cmd.append("--quiet")
+    env = dict(os.environ, FROG_SIM_FS=fs_dir)
+    result = subprocess.run(cmd, stdout=None if verbose else subprocess.DEVNULL,
+                            stderr=subprocess.PIPE, text=True, env=env)
+    metrics = None
+    for line in result.stderr.splitlines():
+        if line.startswith("[SIM] {"):
+            metrics = json.loads(line[6:])
+        elif line:
+            print("  " + line, file=sys.stderr)
+    return result.returncode, metrics
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--sketch", help="only sketches whose path contains this")
+    ap.add_argument("--seconds", type=float, default=120, help="virtual seconds per sketch")
+    ap.add_argument("--port", type=int, default=0, help="stub server port (default: any free)")
+    ap.add_argument("--status", type=int, default=200, help="HTTP status the stub answers with")
+    ap.add_argument("--fail-every", type=int, default=0, help="answer every Nth POST with 503")
+    ap.add_argument("--delay-ms", type=float, default=0, help="stub takes this long to answer each POST")
+    ap.add_argument("--outage", help="Wi-Fi down between these virtual seconds, e.g. 20-60")
+    ap.add_argument("--dht-fail-every", type=int, default=0, help="every Nth DHT read fails")
+    ap.add_argument("--build-dir", default=os.path.join(HOST_DIR, "build"))
+    ap.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    ap.add_argument("--json", help="write all metrics to this file")
+    ap.add_argument("-v", "--verbose", action="store_true", help="show the sketches' serial output")
+    args = ap.parse_args()
+
+    sketches = find_sketches(args.sketch)
+    if not sketches:
+        print("no FrogNode sketches found", file=sys.stderr)
+        return 1
+    os.makedirs(args.build_dir, exist_ok=True)
+
+    StubHandler.status = args.status
+    StubHandler.fail_every = args.fail_every
+    StubHandler.delay_s = args.delay_ms / 1000.0
+    server = start_stub(args.port)
+    port = server.server_address[1]
+
+    rows = []
+    failed = False
+    for path in sketches:
+        label = os.path.relpath(path, SENSOR_DIR)
+        exe, built = build(path, args.build_dir, args.cxx)
+        if built.returncode != 0:
+            print("BUILD FAILED %s\n%s" % (label, built.stderr), file=sys.stderr)
+            failed = True
+            continue
+        StubHandler.stats.reset()
+        code, metrics = run(exe, label, args, port, args.build_dir, args.verbose)
+        if code != 0 or metrics is None:
+            print("RUN FAILED %s (exit %d)" % (label, code), file=sys.stderr)
+            failed = True
+            continue
+        stats = StubHandler.stats
+        metrics["server"] = {"posts": stats.posts, "readings": stats.readings,
+                             "body_bytes": stats.body_bytes, "bad_json": stats.bad}
+        if stats.readings == 0 or stats.bad:
+            failed = True
+        rows.append(metrics)
+
+    server.shutdown()
+
+    head = "%-44s %6s %6s %9s %9s %9s %9s %8s %9s %7s" % (
+        "sketch", "posts", "rows", "sent B", "p50 us", "p99 us", "max us", "allocs", "display B", "awake")
+    print(head)
+    print("-" * len(head))
+    for m in rows:
+        print("%-44s %6d %6d %9d %9.1f %9.1f %9.1f %8d %9d %6.1f%%" % (
+            m["sketch"], m["server"]["posts"], m["server"]["readings"], m["bytes_sent"],
+            m["loop_us"]["p50"], m["loop_us"]["p99"], m["loop_us"]["max"],
+            m["allocs"], m["display_bytes"], m["awake_pct"]))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(rows, f, indent=2)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,174 @@
+"""Out-of-range alerts, sent from a background thread.
+
+log_data() only calls submit(), which puts the reading on an in-process
+queue and returns. The worker thread decides whether it is worth a push:
+
+- hysteresis: a channel goes into alarm when it leaves its range, and
+  only clears once it is back inside by HYSTERESIS, so a value hovering on
+  the limit does not flap
+- cooldown: a channel still in alarm is repeated at most every COOLDOWN
+  seconds, instead of once per reading
+- coalescing: everything that fires within COALESCE seconds of the first
+  alert goes out as one notification
+
+The notifier is any callable notifier(title, message, priority, tags).
+FROG_ALERT_URL picks the default one: an ntfy topic URL (the default),
+another URL to POST the same request to a local stub, or "log" to print
+alerts instead of sending them.
+"""
+
+import os
+import queue
+import threading
+import time
+
+import requests
+
+NTFY_URL = "https://ntfy.sh/thefrogpit"
+TITLE = "🐸 FrogTank Alert"
+
+HYSTERESIS = {"temp": 1.0, "humidity": 2.0}  # °F, %
+COOLDOWN = 30 * 60  # seconds between repeats for a channel still in alarm
+COALESCE = 30  # seconds
+QUEUE_DEPTH = 1000  # readings; more than that and the newest are dropped
+
+UNITS = {"temp": "°F", "humidity": "%"}
+
+
+class NtfyNotifier:
+    """POSTs to ntfy, or to anything that takes the same request."""
+
+    def __init__(self, url, timeout=10):
+        self.url = url
+        self.timeout = timeout
+        self.session = requests.Session()
+
+    def __call__(self, title, message, priority, tags):
+        response = self.session.post(
+            self.url,
+            data=message.encode("utf-8"),
+            headers={"Title": title.encode("utf-8"), "Priority": str(priority), "Tags": ",".join(tags)},
+            timeout=self.timeout,
+        )
+        response.raise_for_status()
+
+
+def log_notifier(title, message, priority, tags):
+    print(f"[ALERT] {title} (priority {priority}): {message}")
+
+
+def default_notifier():
+    url = os.environ.get("FROG_ALERT_URL", NTFY_URL)
+    return log_notifier if url == "log" else NtfyNotifier(url)
+
+
+class Channel:
+    """Alarm state of one sensor channel."""
+
+    __slots__ = ("alarm", "last_sent")
+
+    def __init__(self):
+        self.alarm = False
+        self.last_sent = None
+
+
+class AlertWorker:
+    def __init__(self, thresholds, labels, notifier=None, clock=time.monotonic):
+        self.thresholds = thresholds
+        self.labels = labels
+        self.notifier = notifier
+        self.clock = clock
+        self.queue = queue.Queue(maxsize=QUEUE_DEPTH)
+        self.channels = {}
+        self.pending = []  # (priority, line) waiting for the coalescing window
+        self.pending_since = None
+        self.stats = dict(submitted=0, dropped=0, fired=0, suppressed=0, sent=0, failed=0)
+        self._thread = None
+        self._lock = threading.Lock()
+
+    # --- Request side ---
+
+    def submit(self, sensor, temp, humidity):
+        """Never blocks; a reading that does not fit in the queue is dropped."""
+        self._start()
+        try:
+            self.queue.put_nowait((sensor, {"temp": temp, "humidity": humidity}))
+            self.stats["submitted"] += 1
+        except queue.Full:
+            self.stats["dropped"] += 1
+
+    def _start(self):
+        # Started on first use rather than at import, so it runs in the
+        # process that serves requests.
+        if self._thread is None:
+            with self._lock:
+                if self._thread is None:
+                    if self.notifier is None:
+                        self.notifier = default_notifier()
+                    self._thread = threading.Thread(target=self._run, name="alerts", daemon=True)
+                    self._thread.start()
+
+    # --- Worker side ---
+
+    def _run(self):
+        while True:
+            timeout = None
+            if self.pending_since is not None:
+                timeout = max(0.0, self.pending_since + COALESCE - self.clock())
+            try:
+                sensor, values = self.queue.get(timeout=timeout)
+                self.check(sensor, values)
+            except queue.Empty:
+                pass
+            self.flush()
+
+    def check(self, sensor, values):
+        limits = self.thresholds.get(sensor, self.thresholds["other"])
+        now = self.clock()
+        for key, raw in values.items():
+            try:
+                value = float(raw)
+            except (TypeError, ValueError):
+                continue  # channel not reported
+            low, high = limits[key]
+            channel = self.channels.setdefault((sensor, key), Channel())
+            margin = HYSTERESIS[key]
+            if not channel.alarm:
+                if low <= value <= high:
+                    continue
+                channel.alarm = True
+            elif low + margin <= value <= high - margin:
+                channel.alarm = False
+                if channel.last_sent is not None:
+                    channel.last_sent = None
+                    self.queue_line(3, f"{self.label(sensor)} {key} back in range: {value}{UNITS[key]}")
+                continue
+            if channel.last_sent is not None and now - channel.last_sent < COOLDOWN:
+                self.stats["suppressed"] += 1
+                continue
+            channel.last_sent = now
+            side = "low" if value < low else "high" if value > high else "recovering"
+            self.queue_line(5, f"{self.label(sensor)} {key} {side}: {value}{UNITS[key]} "
+                               f"(range {low}-{high}{UNITS[key]})")
+
+    def label(self, sensor):
+        return self.labels.get(sensor, sensor)
+
+    def queue_line(self, priority, line):
+        self.stats["fired"] += 1
+        if self.pending_since is None:
+            self.pending_since = self.clock()
+        self.pending.append((priority, line))
+
+    def flush(self, force=False):
+        if not self.pending or (not force and self.clock() < self.pending_since + COALESCE):
+            return
+        lines, self.pending, self.pending_since = self.pending, [], None
+        priority = max(p for p, _ in lines)
+        tags = ["frog", "warning", "temp"] if priority >= 5 else ["frog", "white_check_mark"]
+        try:
+            self.notifier(TITLE, "\n".join(line for _, line in lines), priority, tags)
+            self.stats["sent"] += 1
+        except Exception as e:
+            self.stats["failed"] += 1
+            print(f"[ntfy Error] {e}")
@@ -1,9 +1,10 @@
-from flask import Flask, request, jsonify, send_file
+from flask import Flask, Response, request, jsonify, send_file
 from flask_cors import CORS
 from werkzeug.middleware.dispatcher import DispatcherMiddleware
 from werkzeug.serving import run_simple
-import json, time, requests
+import json, time
 from pathlib import Path
+import alerts, frogpack, live, logindex, logstore, rollup
 
 # === Core Flask App ===
 app = Flask(__name__)
@@ -26,6 +27,25 @@ sensor_name_map = {
 }
 sensor_labels = {v: k for k, v in sensor_name_map.items()}
 
+# Wire IDs for the binary payloads (frogpack.py), the name each node sends.
+# Same table as kFrogSensorIds in SensorCode/FrogNode/FrogPack.h; an ID is
+# never reused.
+sensor_ids = {
+    1: "Whites Tree Frog Terrarium",
+    2: "Green Tree Frog Terrarium",
+    3: "Office Sensor",
+    4: "Other Sensor",
+    5: "Red Knee",
+    6: "Avicularia Avicularia",
+    7: "Living Room",
+    8: "Bedroom",
+    9: "3D Printer",
+    10: "White Tree Frog Terrarium",
+    11: "Green Tree Frog",
+    12: "Plant Tank",
+    13: "Aquarium",
+}
+
 thresholds = {
     "whites": {"temp": (70, 85), "humidity": (50, 80)},
     "green": {"temp": (72, 85), "humidity": (50, 80)},
@@ -38,31 +58,125 @@ thresholds = {
     "3d printer": {"temp": (0, 100), "humidity": (0, 100)}
 }
 
+alert_worker = alerts.AlertWorker(thresholds, sensor_labels)
+
+# Server-Sent Events of new readings, on its own port (live.py)
+live_hub = live.LiveHub()
+
+# Sensor logs, one partition per day under logs/<sensor>/ (logstore.py)
+log_store = logstore.LogStore(logdir)
+
+# Value columns of a log row, after "time,sensor"
+log_fields = ("temp", "humidity", "lux", "tds")
+
+# Newest row of each sensor's log by time, as [time, sensor, *log_fields]
+# strings. Serves /sensor/<name> without touching the file, and nodes leave
+# out channels that have not moved past their deadband, so missing values
+# of live readings are carried forward from here. Updated on ingest (a
+# batch of older, spooled rows leaves it alone) and filled from the newest
+# day of each log at startup. last_stats holds the log's version() each
+# row was read at, so a log written by anything else (another worker
+# process) is read again.
+last_rows = {}
+last_stats = {}
+
 # === Routes ===
 
 @app.route("/sensor/<sensor_name>")
 def latest(sensor_name):
-    logfile = logdir / f"{sensor_name}.csv"
-    try:
-        with open(logfile) as f:
-            last = f.readlines()[-1].strip().split(",")
-            return jsonify({
-                "time": last[0],
-                "sensor": sensor_labels.get(sensor_name, sensor_name),
-                "temp": last[2],
-                "humidity": last[3],
-                "lux": last[4] if len(last) > 4 else None,
-                "tds": last[5] if len(last) > 5 else None
-            })
-    except Exception as e:
-        return jsonify({"error": "no data", "detail": str(e)}), 404
+    row = last_row(sensor_name)
+    if row is None:
+        return jsonify({"error": "no data", "detail": f"no log for {sensor_name}"}), 404
+    return jsonify(reading_json(sensor_name, row))
+
+@app.route("/sensors")
+def latest_all():
+    # Every sensor's latest reading in one response, keyed by sensor, for
+    # the dashboards' poll. The ETag only changes when a reading does, so a
+    # poll sent with If-None-Match gets an empty 304 until then.
+    readings = {}
+    for sensor in log_store.sensors():
+        row = last_row(sensor)
+        if row is not None:
+            readings[sensor] = reading_json(sensor, row)
+    response = jsonify(readings)
+    response.add_etag()
+    response.headers["Cache-Control"] = "no-cache"
+    return response.make_conditional(request)
 
 @app.route("/sensor/<sensor_name>-log")
 def sensor_log(sensor_name):
-    logfile = logdir / f"{sensor_name}.csv"
-    if not logfile.exists():
+    # Every day's rows in turn, decompressed as they go out.
+    # ?after= (epoch seconds or "YYYY-MM-DD HH:MM:SS") gives only the rows
+    # after that time, so a chart that has the rest fetches just what is
+    # new. Without it, Range requests are honoured (If-Range with the ETag),
+    # so a download can carry on from the bytes it already has.
+    log = log_store.get(sensor_name)
+    if log is None:
         return "Log file not found", 404
-    return send_file(logfile, mimetype="text/plain")
+    if request.args.get("after"):
+        try:
+            after = query_time(request.args["after"])
+        except ValueError as e:
+            return jsonify({"error": str(e)}), 400
+        rows = (line for line in log.rows(after) if logindex.row_time(line) > after)
+        return Response(rows, mimetype="text/plain")
+
+    parts = log.parts()
+    length = sum(n for _, n in parts)
+    etag = log.etag(parts)
+    span = None
+    # A log changed since the client's copy (If-Range) is sent whole
+    if request.range and ("If-Range" not in request.headers or request.if_range.etag == etag):
+        span = request.range.range_for_length(length)
+        # Only a single range that starts past the end is unsatisfiable;
+        # several ranges, or one we can't serve, get the whole log
+        ranges = request.range.ranges
+        if span is None and len(ranges) == 1 and ranges[0][0] >= length:
+            return Response(status=416, headers={"Content-Range": f"bytes */{length}"})
+    start, stop = span or (0, length)
+    response = Response(log.read(parts, start, stop), status=206 if span else 200, mimetype="text/plain")
+    response.headers["Content-Length"] = str(stop - start)
+    response.headers["Accept-Ranges"] = "bytes"
+    response.set_etag(etag)
+    if span:
+        response.headers["Content-Range"] = request.range.make_content_range(length).to_header()
+    return response
+
+@app.route("/sensor/<sensor_name>-query")
+def sensor_query(sensor_name):
+    # ?from=&to= in epoch seconds (or "YYYY-MM-DD HH:MM:SS"), both optional.
+    # ?limit=N keeps only the newest N rows of the range. Same CSV rows as
+    # -log; only the days in the range are read.
+    log = log_store.get(sensor_name)
+    if log is None:
+        return "Log file not found", 404
+    try:
+        lo = query_time(request.args.get("from"))
+        hi = query_time(request.args.get("to"))
+        limit = request.args.get("limit", type=int)
+    except ValueError as e:
+        return jsonify({"error": str(e)}), 400
+    if limit is not None and limit < 0:
+        return jsonify({"error": "limit must be >= 0"}), 400
+    return Response(log.rows(lo, hi, limit), mimetype="text/plain")
+
+@app.route("/sensor/<sensor_name>-rollup")
+def sensor_rollup(sensor_name):
+    # ?from=&to= in epoch seconds (default: the last day), ?points= the
+    # chart's width. Buckets from the coarsest tier (rollup.py) that still
+    # fills it, as columns: time, and count/min/max/mean for every field.
+    if log_store.get(sensor_name) is None:
+        return jsonify({"error": "no data", "detail": f"no log for {sensor_name}"}), 404
+    try:
+        hi = request.args.get("to", time.time(), type=float)
+        lo = request.args.get("from", hi - 86400, type=float)
+        points = min(max(request.args.get("points", 300, type=int), 1), 5000)
+    except ValueError as e:
+        return jsonify({"error": str(e)}), 400
+    if not lo < hi:
+        return jsonify({"error": "from must be before to"}), 400
+    return jsonify(rollups.query(sensor_name, lo, hi, points))
 
 @app.route("/graph/<sensor_name>")
 def graph_page(sensor_name):
@@ -72,44 +186,162 @@ def graph_page(sensor_name):
 def dashboard_home():
     return send_file("/var/www/dashboard/index.html")
 
+def reading_time(device_ts, now):
+    # Nodes stamp readings (epoch seconds) once their clock has synced, so
+    # readings spooled through an outage keep the time they were taken.
+    try:
+        ts = float(device_ts)
+        if 0 < ts <= now + 300:
+            return time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(ts))
+    except (TypeError, ValueError):
+        pass
+    return time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(now))
+
+def query_time(value):
+    # Epoch seconds, or a local time as the log writes it (a date alone is
+    # its midnight)
+    if not value:
+        return None
+    try:
+        return time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(float(value))).encode()
+    except (ValueError, OverflowError, OSError):
+        pass
+    for fmt in ("%Y-%m-%d %H:%M:%S", "%Y-%m-%d"):
+        try:
+            return time.strftime("%Y-%m-%d %H:%M:%S", time.strptime(value, fmt)).encode()
+        except ValueError:
+            pass
+    raise ValueError(f"bad time {value!r}")
+
+def last_row(sensor):
+    log = log_store.get(sensor)
+    version = log.version() if log else None
+    if version is None:
+        return None
+    if last_stats.get(sensor) != version:
+        line = log.last_line()
+        row = line.split(",") if line else [""] * 2
+        width = 2 + len(log_fields)
+        last_rows[sensor] = (row + [""] * width)[:width]
+        last_stats[sensor] = version
+    return last_rows[sensor]
+
+def reading_json(sensor, row):
+    return {
+        "time": row[0],
+        "sensor": sensor_labels.get(sensor, sensor),
+        "temp": row[2],
+        "humidity": row[3],
+        "lux": row[4] or None,
+        "tds": row[5] or None
+    }
+
+def row_before(sensor, ts):
+    # (time, values) of the sensor's newest logged row at or before ts. For
+    # live readings that is the cached latest row; spooled backlog looks
+    # back in the log.
+    row = last_row(sensor)
+    if row is None:
+        return "", [""] * len(log_fields)
+    if row[0] > ts:
+        lines = log_store.get(sensor).rows(None, ts.encode(), limit=1)
+        if not lines:
+            return "", [""] * len(log_fields)
+        row = (lines[0].decode("utf-8", "replace").rstrip("\n").split(",") + [""] * len(row))[:len(row)]
+    return row[0], row[2:]
+
+def decode_readings():
+    # Nodes send either one reading object or a JSON array of every
+    # reading from their cycle, or the same as a binary batch (frogpack.py)
+    decoder = frogpack.DECODERS.get(request.mimetype)
+    if decoder:
+        try:
+            readings = decoder(request.get_data())
+        except ValueError as e:
+            return None, str(e)
+        for reading in readings:
+            sensor_id = reading.pop("id")
+            reading["sensor"] = sensor_ids.get(sensor_id, f"sensor {sensor_id}")
+        return readings, None
+    data = request.get_json(silent=True)
+    if isinstance(data, dict):
+        return [data], None
+    if isinstance(data, list) and all(isinstance(r, dict) for r in data):
+        return data, None
+    return None, "expected a JSON object or array of objects"
+
 @app.route("/api/sensor", methods=["POST"])
 def log_data():
-    data = request.json
-    full_name = data.get("sensor", "unknown")
-    sensor = sensor_name_map.get(full_name, full_name.lower())
-    ts = time.strftime("%Y-%m-%d %H:%M:%S")
-    logfile = logdir / f"{sensor}.csv"
-
-    # Extract all readings
-    temp = data.get("temp", "")
-    humidity = data.get("humidity", "")
-    lux = data.get("lux", "")
-    tds = data.get("tds", "")
-
-    with open(logfile, "a") as f:
-        f.write(f"{ts},{sensor},{temp},{humidity},{lux},{tds}\n")
-
-    # Optional: alert logic for temp/humidity
-    try:
-        temp_val = float(temp)
-        humidity_val = float(humidity)
-        limits = thresholds.get(sensor, thresholds["other"])
-
-        if not (limits["temp"][0] <= temp_val <= limits["temp"][1]) or not (limits["humidity"][0] <= humidity_val <= limits["humidity"][1]):
-            alert_msg = f"{sensor_labels.get(sensor, sensor)} out of range!\nTemp: {temp_val}°F | Humidity: {humidity_val}%"
-            requests.post(
-                "https://ntfy.sh/thefrogpit",
-                data=alert_msg.encode("utf-8"),
-                headers={
-                    "Title": "🐸 FrogTank Alert",
-                    "Priority": "5",
-                    "Tags": "frog,warning,temp"
-                }
-            )
-    except Exception as e:
-        print(f"[ntfy Error] {e}")
-
-    return jsonify({"status": "ok"}), 200
+    readings, error = decode_readings()
+    if error:
+        return jsonify({"error": error}), 400
+
+    now = time.time()
+
+    # Group readings by sensor so each day's log file is opened once per batch
+    batches = {}
+    for reading in readings:
+        full_name = reading.get("sensor", "unknown")
+        sensor = sensor_name_map.get(full_name, full_name.lower())
+        ts = reading_time(reading.get("ts"), now)
+        batches.setdefault(sensor, []).append((ts, reading))
+
+    rows = {}
+    for sensor, sensor_readings in batches.items():
+        # Backlog from a node's spool can arrive in the same batch as live rows
+        sensor_readings.sort(key=lambda item: item[0])
+        prev_ts, values = "", None
+        for ts, reading in sensor_readings:
+            # A channel the reading leaves out has not changed since the node
+            # last sent it, so every row is still complete. What it carries
+            # forward is the row before it in time: the previous one in this
+            # batch, or one already logged if that is later.
+            logged_ts, logged = row_before(sensor, ts)
+            if values is None or logged_ts > prev_ts:
+                values = logged
+            values = [reading[k] if k in reading else prev for k, prev in zip(log_fields, values)]
+            prev_ts = ts
+            rows.setdefault(sensor, []).append((ts, values, f"{ts},{sensor},{','.join(map(str, values))}\n"))
+
+    newer_than = {}  # sensor -> time of the latest row before this batch
+    for sensor, sensor_rows in rows.items():
+        latest = last_row(sensor)
+        newer_than[sensor] = latest[0] if latest else ""
+        log = log_store.create(sensor)
+        log.append(line for _, _, line in sensor_rows)
+        # A batch of backlog alone leaves the latest reading as it was
+        ts, values, _ = sensor_rows[-1]
+        if latest is None or ts >= latest[0]:
+            last_rows[sensor] = [ts, sensor] + [str(v) for v in values]
+        last_stats[sensor] = log.version()
+        rollups.add(sensor, [(ts, [str(v) for v in values]) for ts, values, _ in sensor_rows])
+
+    # Dashboards with a live stream open get each row as it is logged
+    for sensor, sensor_rows in rows.items():
+        for ts, values, _ in sensor_rows:
+            live_hub.publish(sensor, reading_json(sensor, [ts, sensor] + [str(v) for v in values]))
+
+    # Out-of-range checks and pushes happen on the alert worker's thread.
+    # Backlog a node replays after an outage is history, not news: only
+    # rows newer than the sensor's latest are checked.
+    for sensor, sensor_rows in rows.items():
+        for ts, values, _ in sensor_rows:
+            if ts > newer_than[sensor]:
+                alert_worker.submit(sensor, values[0], values[1])
+
+    return jsonify({"status": "ok", "count": len(readings)}), 200
+
+# Minute/hour/day rollups for the graphs, kept up to date by log_data()
+rollups = rollup.Rollups(logdir / "rollups", log_fields, log_store.get)
+
+# Warm the latest-row cache so the first dashboard refresh is as cheap as
+# the rest. A log still in one flat file is split into days here, and
+# rollups missing or behind the log are built before serving starts.
+for sensor in log_store.sensors():
+    last_row(sensor)
+    rollups.get(sensor)
+
+live_hub.start()
 
 # === Mount app under /frogtank ===
 application = DispatcherMiddleware(Flask("dummy"), {
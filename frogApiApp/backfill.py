@@ -2,6 +2,8 @@ import time
 from pathlib import Path
 from random import uniform
 
+from logstore import PartitionedLog
+
 logdir = Path("/home/thefrogpit/frog-api/logs")
 logdir.mkdir(parents=True, exist_ok=True)
 
@@ -19,7 +21,6 @@ for key in sensors:
         ts = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(now - (100 - i) * 60))
         temp = round(uniform(40.0, 50.0), 1)     # Low fake Fahrenheit
         humidity = round(uniform(10.0, 25.0), 1) # Low fake Humidity
-        lines.append(f"{ts},{key},{temp},{humidity}")
+        lines.append(f"{ts},{key},{temp},{humidity}\n")
     
-    with open(logdir / f"{key}.csv", "w") as f:
-        f.write("\n".join(lines))
+    PartitionedLog(logdir / key).append(lines)
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Size and decode speed of the /api/sensor payload formats.
+
+    python3 frogApiApp/bench_payloads.py [--seconds 1]
+
+Builds the batches a node sends (one reading, a 3-sensor cycle, a
+12-reading spool drain) as JSON, packed and CBOR, prints their sizes, then
+times how many readings per second the server decodes in each format.
+First it checks that malformed bodies are rejected with ValueError, which
+app.py answers with 400.
+JSON is decoded with json.loads, the binary formats with frogpack.py (and
+cbor2 too, if it is installed). The encoders here write the same bytes as
+FrogJsonWriter and FrogPackWriter on the nodes.
+"""
+
+import argparse
+import json
+import random
+import time
+
+import frogpack
+
+IDS = {"Green Tree Frog": 11, "Plant Tank": 12, "Living Room": 7}
+
+
+def cycle(seq, ts):
+    rnd = random.Random(seq)
+    return [
+        {"sensor": "Green Tree Frog", "ts": ts, "seq": seq, "temp": round(rnd.uniform(70, 80), 1),
+         "humidity": round(rnd.uniform(50, 80), 1), "lux": round(rnd.uniform(0, 900), 1)},
+        {"sensor": "Plant Tank", "ts": ts, "seq": seq + 1, "temp": round(rnd.uniform(70, 80), 1),
+         "humidity": round(rnd.uniform(50, 80), 1), "lux": round(rnd.uniform(0, 900), 1)},
+        {"sensor": "Living Room", "ts": ts, "seq": seq + 2, "temp": round(rnd.uniform(65, 75), 1),
+         "humidity": round(rnd.uniform(30, 50), 1), "tds": round(rnd.uniform(200, 400), 1),
+         "water_level": round(rnd.uniform(60, 90), 1)},
+    ]
+
+
+def encode_json(readings):
+    # Same text as FrogJsonWriter: no spaces, one decimal.
+    parts = []
+    for r in readings:
+        fields = [f'"sensor":"{r["sensor"]}"']
+        for key in ("ts", "seq"):
+            if r.get(key):
+                fields.append(f'"{key}":{r[key]}')
+        for key in frogpack.FIELDS:
+            if r.get(key) is not None:
+                fields.append(f'"{key}":{r[key]:.1f}')
+        parts.append("{" + ",".join(fields) + "}")
+    return ("[" + ",".join(parts) + "]").encode()
+
+
+FORMATS = [
+    ("json", encode_json, json.loads),
+    ("packed", lambda rs: frogpack.encode_packed(rs, IDS), frogpack.decode_packed),
+    ("cbor", lambda rs: frogpack.encode_cbor(rs, IDS), frogpack.decode_cbor),
+]
+
+
+# Bodies that must fail to decode, not crash the request.
+MALFORMED = [
+    (frogpack.decode_cbor, "9fa18000ff", "array as a map key"),
+    (frogpack.decode_cbor, "9fa10ac4828001ff", "decimal fraction with a non-integer mantissa"),
+    (frogpack.decode_cbor, "9fa10080ff", "array as the sensor ID"),
+    (frogpack.decode_cbor, "9fa10a80ff", "array as a value"),
+    (frogpack.decode_cbor, "9fa10ac482193e8001ff", "decimal fraction exponent out of range"),
+    (frogpack.decode_cbor, "9fbf80ffff", "array as an indefinite map key"),
+    (frogpack.decode_cbor, "9fa1", "truncated"),
+    (frogpack.decode_packed, "460101", "truncated packed batch"),
+]
+
+
+def check_malformed():
+    for decode, hex_body, what in MALFORMED:
+        try:
+            decode(bytes.fromhex(hex_body))
+        except ValueError:
+            continue
+        raise AssertionError(f"{decode.__name__} accepted {what}: {hex_body}")
+
+
+def rate(decode, body, count, seconds):
+    n = 0
+    start = time.perf_counter()
+    deadline = start + seconds
+    while time.perf_counter() < deadline:
+        for _ in range(100):
+            decode(body)
+        n += 100
+    return n * count / (time.perf_counter() - start)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--seconds", type=float, default=1.0, help="time per decode measurement")
+    args = ap.parse_args()
+    check_malformed()
+
+    ts = 1760000000
+    batches = {
+        "1 reading": cycle(100, ts)[:1],
+        "3-sensor cycle": cycle(100, ts),
+        "12-reading drain": [r for i in range(4) for r in cycle(100 + 3 * i, ts + 10 * i)],
+    }
+
+    print("Encoded size (bytes; per reading in brackets)")
+    print("%-18s" % "" + "".join("%16s" % name for name, _, _ in FORMATS))
+    for label, readings in batches.items():
+        row = "%-18s" % label
+        for _, encode, _ in FORMATS:
+            size = len(encode(readings))
+            row += "%16s" % ("%d (%.1f)" % (size, size / len(readings)))
+        print(row)
+
+    decoders = list(FORMATS)
+    try:
+        import cbor2
+        decoders.append(("cbor (cbor2)", FORMATS[2][1], cbor2.loads))
+    except ImportError:
+        pass
+
+    readings = batches["12-reading drain"]
+    print("\nDecode, 12-reading batch (readings/s)")
+    base = None
+    for name, encode, decode in decoders:
+        body = encode(readings)
+        assert len(decode(body)) == len(readings)
+        r = rate(decode, body, len(readings), args.seconds)
+        base = base or r
+        print("%-18s %12.0f  %5.2fx json" % (name, r, r / base))
+
+
+if __name__ == "__main__":
+    main()
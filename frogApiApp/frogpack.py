@@ -0,0 +1,258 @@
+"""Binary /api/sensor payloads (SensorCode/FrogNode/FrogPack.h).
+
+Two formats besides JSON, told apart by Content-Type:
+
+application/x-frogpack, version 1
+    batch   'F' version count:u8 record*count
+    record  id:u8 mask:u8 ts:u32le seq:varint value:zigzag-varint*
+    Bit c of mask = channel c present; values follow in FIELDS order, each
+    scaled by 10**DECIMALS[c].
+
+application/cbor
+    An array of maps {0: id, 1: ts, 2: seq, 10+c: value}, values as CBOR
+    decimal fractions (tag 4). Only the subset the nodes write is decoded:
+    integers, arrays, maps, tag 4 and floats.
+
+Both decode to the dicts a JSON reading would give, with "id" in place of
+"sensor"; app.py maps the ID to the sensor name.
+"""
+
+import struct
+
+MAGIC = ord("F")
+VERSION = 1
+FIELDS = ("temp", "humidity", "lux", "tds", "water_level")
+DECIMALS = (1, 1, 1, 1, 1)
+SCALES = tuple(10 ** d for d in DECIMALS)
+
+PACKED_TYPE = "application/x-frogpack"
+CBOR_TYPE = "application/cbor"
+
+_u32 = struct.Struct("<I")
+_head = struct.Struct("<BBI")  # id, mask, ts
+
+
+# --- Packed ---
+
+def decode_packed(body):
+    if len(body) < 3 or body[0] != MAGIC:
+        raise ValueError("not a frogpack batch")
+    if body[1] != VERSION:
+        raise ValueError(f"frogpack version {body[1]} not supported")
+    count = body[2]
+    pos = 3
+    readings = []
+    channels = tuple(zip(FIELDS, SCALES, (1 << c for c in range(len(FIELDS)))))
+    head = _head.unpack_from
+    try:
+        for _ in range(count):
+            sensor_id, mask, ts = head(body, pos)
+            pos += 6
+            seq = body[pos]
+            pos += 1
+            if seq >= 0x80:
+                seq, pos = _varint(body, pos - 1)
+            reading = {"id": sensor_id}
+            if ts:
+                reading["ts"] = ts
+            if seq:
+                reading["seq"] = seq
+            for field, scale, bit in channels:
+                if mask & bit:
+                    z = body[pos]
+                    pos += 1
+                    if z >= 0x80:
+                        z, pos = _varint(body, pos - 1)
+                    reading[field] = ((z >> 1) ^ -(z & 1)) / scale
+            readings.append(reading)
+    except (IndexError, struct.error):
+        raise ValueError("truncated frogpack batch")
+    if pos != len(body):
+        raise ValueError("trailing bytes after frogpack batch")
+    return readings
+
+
+def _varint(body, pos):
+    value = shift = 0
+    while True:
+        b = body[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if b < 0x80:
+            return value, pos
+        shift += 7
+        if shift > 35:
+            raise ValueError("varint too long")
+
+
+def encode_packed(readings, ids):
+    """Host-side encoder, for tests and benchmarks. ids: sensor name -> ID."""
+    out = bytearray((MAGIC, VERSION, len(readings)))
+    for r in readings:
+        mask, values = 0, []
+        for c, field in enumerate(FIELDS):
+            if r.get(field) is not None:
+                mask |= 1 << c
+                v = int(round(r[field] * SCALES[c]))
+                values.append((v << 1) ^ (v >> 31))
+        out += bytes((ids[r["sensor"]], mask)) + _u32.pack(r.get("ts", 0))
+        for v in [r.get("seq", 0)] + values:
+            while v >= 0x80:
+                out.append((v & 0x7F) | 0x80)
+                v >>= 7
+            out.append(v)
+    return bytes(out)
+
+
+# --- CBOR ---
+
+def decode_cbor(body):
+    try:
+        value, pos = _cbor_item(body, 0)
+    except (struct.error, RecursionError):
+        raise ValueError("truncated or malformed CBOR")
+    if pos != len(body):
+        raise ValueError("trailing bytes after CBOR item")
+    if not isinstance(value, list) or not all(isinstance(m, dict) for m in value):
+        raise ValueError("expected a CBOR array of maps")
+    readings = []
+    for m in value:
+        for key in (0, 1, 2):
+            if not _is_int(m.get(key, 0)):
+                raise ValueError(f"CBOR key {key} must be an integer")
+        reading = {"id": m.get(0, 0)}
+        if m.get(1):
+            reading["ts"] = m[1]
+        if m.get(2):
+            reading["seq"] = m[2]
+        for c, field in enumerate(FIELDS):
+            if 10 + c in m:
+                v = m[10 + c]
+                if not _is_int(v) and not isinstance(v, float):
+                    raise ValueError(f"CBOR {field} must be a number")
+                reading[field] = v
+        readings.append(reading)
+    return readings
+
+
+def _is_int(v):
+    return isinstance(v, int) and not isinstance(v, bool)
+
+
+_BREAK = object()
+
+
+def _cbor_item(body, pos):
+    try:
+        head = body[pos]
+    except IndexError:
+        raise ValueError("truncated CBOR")
+    pos += 1
+    major, info = head >> 5, head & 0x1F
+    if head == 0xFF:
+        return _BREAK, pos
+    if major == 7:
+        if info == 25:
+            return struct.unpack_from(">e", body, pos)[0], pos + 2
+        if info == 26:
+            return struct.unpack_from(">f", body, pos)[0], pos + 4
+        if info == 27:
+            return struct.unpack_from(">d", body, pos)[0], pos + 8
+        if info in (20, 21, 22):
+            return (False, True, None)[info - 20], pos
+        raise ValueError(f"unsupported CBOR simple value {info}")
+    if info == 31 and major in (4, 5):
+        items = []
+        while True:
+            item, pos = _cbor_item(body, pos)
+            if item is _BREAK:
+                break
+            items.append(item)
+        if major == 4:
+            return items, pos
+        if len(items) % 2 or not all(_is_int(k) for k in items[::2]):
+            raise ValueError("CBOR map keys must be integers")
+        return dict(zip(items[::2], items[1::2])), pos
+    if info < 24:
+        arg = info
+    elif info <= 27:
+        size = 1 << (info - 24)
+        if pos + size > len(body):
+            raise ValueError("truncated CBOR")
+        arg = int.from_bytes(body[pos:pos + size], "big")
+        pos += size
+    else:
+        raise ValueError("bad CBOR argument")
+    if major == 0:
+        return arg, pos
+    if major == 1:
+        return -1 - arg, pos
+    if major == 4:
+        items = []
+        for _ in range(arg):
+            item, pos = _cbor_item(body, pos)
+            items.append(item)
+        return items, pos
+    if major == 5:
+        m = {}
+        for _ in range(arg):
+            k, pos = _cbor_item(body, pos)
+            if not _is_int(k):
+                raise ValueError("CBOR map keys must be integers")
+            m[k], pos = _cbor_item(body, pos)
+        return m, pos
+    if major == 6:
+        item, pos = _cbor_item(body, pos)
+        if arg == 4:
+            if not (isinstance(item, list) and len(item) == 2 and all(_is_int(v) for v in item)):
+                raise ValueError("CBOR decimal fraction must be [exponent, mantissa] integers")
+            exponent, mantissa = item
+            if abs(exponent) > 38:
+                raise ValueError("CBOR decimal fraction exponent out of range")
+            return mantissa / 10 ** -exponent if exponent < 0 else mantissa * 10 ** exponent, pos
+        return item, pos
+    raise ValueError(f"unsupported CBOR major type {major}")
+
+
+def encode_cbor(readings, ids):
+    """Host-side encoder, for tests and benchmarks. ids: sensor name -> ID."""
+    out = bytearray([0x9F])
+
+    def head(major, arg):
+        if arg < 24:
+            out.append(major << 5 | arg)
+        elif arg <= 0xFF:
+            out.extend((major << 5 | 24, arg))
+        elif arg <= 0xFFFF:
+            out.append(major << 5 | 25)
+            out.extend(arg.to_bytes(2, "big"))
+        else:
+            out.append(major << 5 | 26)
+            out.extend(arg.to_bytes(4, "big"))
+
+    def integer(v):
+        head(1, -1 - v) if v < 0 else head(0, v)
+
+    for r in readings:
+        pairs = [(0, ids[r["sensor"]])]
+        if r.get("ts"):
+            pairs.append((1, r["ts"]))
+        if r.get("seq"):
+            pairs.append((2, r["seq"]))
+        values = [(10 + c, r[f]) for c, f in enumerate(FIELDS) if r.get(f) is not None]
+        head(5, len(pairs) + len(values))
+        for k, v in pairs:
+            head(0, k)
+            head(0, v)
+        for k, v in values:
+            c = k - 10
+            head(0, k)
+            if DECIMALS[c]:
+                out.extend((0xC4, 0x82))
+                integer(-DECIMALS[c])
+            integer(int(round(v * SCALES[c])))
+    out.append(0xFF)
+    return bytes(out)
+
+
+DECODERS = {PACKED_TYPE: decode_packed, CBOR_TYPE: decode_cbor}
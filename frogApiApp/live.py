@@ -0,0 +1,201 @@
+"""Live stream of new readings, as Server-Sent Events.
+
+    GET /frogtank/live[?sensor=green&sensor=office]
+
+Each reading log_data() logs is pushed to every open stream as
+
+    id: 1792222489123
+    event: reading
+    data: {"sensor_id": "green", "time": ..., "temp": ..., ...}
+
+A stream is a request that never finishes. The Flask app is served by
+run_simple, which handles one request at a time, so one open dashboard
+tab would stall every POST; a threaded server would still tie up a thread
+per tab. The hub runs its own asyncio server on a separate port instead
+(nginx sends /frogtank/live there), in one background thread, and holds
+any number of viewers as coroutines. publish() may be called from any
+thread.
+
+app.py starts the hub when it is imported, so every process that imports
+it tries to bind PORT. Only one can: if the app is run as several worker
+processes, the others print "not streaming" and their publish() does
+nothing, so readings POSTed to them reach the dashboards only on their
+next poll. Run the app as a single process to stream every reading.
+
+The last BACKLOG events are kept. A browser that reconnects sends the id
+of the last event it saw in Last-Event-ID and gets everything after it;
+if that is no longer kept (or the server restarted), it gets a "reset"
+event and should fetch the latest readings again. Ids start at the
+server's start time in milliseconds, so they keep increasing across
+restarts.
+
+A viewer that falls QUEUE_DEPTH events behind is disconnected rather than
+buffered without bound; its browser reconnects and catches up from the
+backlog. A comment line goes out every HEARTBEAT seconds so proxies keep
+an idle stream open and a dead one is noticed.
+"""
+
+import asyncio
+import collections
+import json
+import threading
+import time
+from urllib.parse import parse_qs, urlsplit
+
+PORT = 5021
+PATH = "/live"  # served at any path ending in this
+BACKLOG = 1000  # events; about 20 minutes of every sensor
+QUEUE_DEPTH = 256  # events a viewer may fall behind
+HEARTBEAT = 15  # seconds
+RETRY = 5000  # ms the browser waits before reconnecting
+
+HEADERS = (
+    b"HTTP/1.1 200 OK\r\n"
+    b"Content-Type: text/event-stream\r\n"
+    b"Cache-Control: no-cache\r\n"
+    b"Connection: keep-alive\r\n"
+    b"X-Accel-Buffering: no\r\n"
+    b"Access-Control-Allow-Origin: *\r\n"
+    b"\r\n"
+)
+
+
+def format_event(event_id, kind, data):
+    return b"id: %d\nevent: %s\ndata: %s\n\n" % (event_id, kind, data)
+
+
+class Viewer:
+    __slots__ = ("sensors", "queue")
+
+    def __init__(self, sensors):
+        self.sensors = sensors  # None for all
+        self.queue = asyncio.Queue(maxsize=QUEUE_DEPTH)
+
+    def wants(self, sensor):
+        return self.sensors is None or sensor in self.sensors
+
+
+class LiveHub:
+    def __init__(self, host="127.0.0.1", port=PORT):
+        self.host, self.port = host, port
+        self.events = collections.deque(maxlen=BACKLOG)  # (id, sensor, frame)
+        self.next_id = int(time.time() * 1000)
+        self.viewers = set()
+        self.loop = None
+        self.stats = dict(published=0, connected=0, dropped=0)
+
+    # --- Any thread ---
+
+    def start(self):
+        """Starts the server thread. Returns False if the port is taken."""
+        ready = threading.Event()
+        failed = []
+
+        def run():
+            loop = asyncio.new_event_loop()
+            try:
+                loop.run_until_complete(asyncio.start_server(self._serve, self.host, self.port))
+            except OSError as e:
+                failed.append(e)
+                ready.set()
+                return
+            self.loop = loop
+            ready.set()
+            loop.run_forever()
+
+        threading.Thread(target=run, name="live", daemon=True).start()
+        ready.wait()
+        if failed:
+            print(f"[live] not streaming: {failed[0]}")
+        return not failed
+
+    def publish(self, sensor, reading):
+        """Pushes one reading (a JSON-able dict) to the sensor's viewers."""
+        if self.loop is None:
+            return
+        data = json.dumps(dict(sensor_id=sensor, **reading), separators=(",", ":")).encode()
+        self.loop.call_soon_threadsafe(self._publish, sensor, data)
+
+    # --- Server thread ---
+
+    def _publish(self, sensor, data):
+        event_id, self.next_id = self.next_id, self.next_id + 1
+        frame = format_event(event_id, b"reading", data)
+        self.events.append((event_id, sensor, frame))
+        self.stats["published"] += 1
+        for viewer in list(self.viewers):
+            if not viewer.wants(sensor):
+                continue
+            try:
+                viewer.queue.put_nowait(frame)
+            except asyncio.QueueFull:
+                self.stats["dropped"] += 1
+                self.viewers.discard(viewer)
+                viewer.queue = None  # tells its coroutine to hang up
+
+    def _backlog(self, viewer, last_id):
+        # Everything after last_id, or None if some of it is gone
+        first = self.events[0][0] if self.events else self.next_id
+        if last_id < first - 1:
+            return None
+        return [frame for event_id, sensor, frame in self.events
+                if event_id > last_id and viewer.wants(sensor)]
+
+    async def _serve(self, reader, writer):
+        try:
+            request = await asyncio.wait_for(reader.readuntil(b"\r\n\r\n"), HEARTBEAT)
+            method, target, headers = parse_request(request)
+            url = urlsplit(target)
+            if method != "GET" or not url.path.rstrip("/").endswith(PATH):
+                writer.write(b"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n")
+                await writer.drain()
+                return
+            sensors = parse_qs(url.query).get("sensor")
+            viewer = Viewer(set(sensors) if sensors else None)
+
+            # Replayed and registered without awaiting in between, so no
+            # event can fall into the gap.
+            writer.write(HEADERS + b"retry: %d\n\n" % RETRY)
+            last_id = headers.get("last-event-id", "")
+            if last_id.isdigit():
+                frames = self._backlog(viewer, int(last_id))
+                if frames is None:
+                    frames = [format_event(self.next_id - 1, b"reset", b"{}")]
+                writer.write(b"".join(frames))
+            self.viewers.add(viewer)
+            self.stats["connected"] += 1
+            try:
+                await self._stream(viewer, writer)
+            finally:
+                self.viewers.discard(viewer)
+                self.stats["connected"] -= 1
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, asyncio.TimeoutError,
+                ConnectionError, ValueError):
+            pass
+        finally:
+            writer.close()
+
+    async def _stream(self, viewer, writer):
+        while viewer.queue is not None:
+            # A viewer that stops reading is hung up on, not waited for
+            await asyncio.wait_for(writer.drain(), 2 * HEARTBEAT)
+            try:
+                frame = await asyncio.wait_for(viewer.queue.get(), HEARTBEAT)
+            except asyncio.TimeoutError:
+                writer.write(b": ping\n\n")
+                continue
+            frames = [frame]
+            while viewer.queue is not None and not viewer.queue.empty():
+                frames.append(viewer.queue.get_nowait())
+            writer.write(b"".join(frames))
+
+
+def parse_request(data):
+    lines = data.decode("latin-1").split("\r\n")
+    method, target, _ = lines[0].split(" ", 2)
+    headers = {}
+    for line in lines[1:]:
+        if ":" in line:
+            name, value = line.split(":", 1)
+            headers[name.strip().lower()] = value.strip()
+    return method, target, headers
@@ -0,0 +1,198 @@
+"""Sparse time index over an append-only CSV file, for range queries.
+
+Only the rollup tier files (rollup.py) are read through it now. Raw
+sensor logs live in the day-partitioned store (logstore.py), and
+migrating a flat log there removes the <sensor>.idx it used to have.
+
+The file is split into blocks of about BLOCK bytes, each ending on a line
+break. A .idx next to it (<sensor>.1m.idx for <sensor>.1m.csv) has one
+line per block:
+
+    start,end,first_time,last_time
+
+with first/last the earliest and latest row time in the block. Row times
+are "YYYY-MM-DD HH:MM:SS", which sort as text. Tier files are written in
+order, but each block still keeps its own min/max instead of assuming
+the file is sorted.
+
+A query reads only the blocks whose span overlaps the range, plus the
+unindexed tail (under one block). The index is brought up to date on each
+query by indexing whatever whole blocks were appended since, and rebuilt
+if the file got shorter (truncate() keeps it when the cut is known).
+"""
+
+import os
+import threading
+
+BLOCK = 64 * 1024
+
+
+class Block:
+    __slots__ = ("start", "end", "first", "last")
+
+    def __init__(self, start, end, first, last):
+        self.start, self.end, self.first, self.last = start, end, first, last
+
+    def overlaps(self, lo, hi):
+        return (lo is None or self.last >= lo) and (hi is None or self.first <= hi)
+
+
+def row_time(line):
+    return line.split(b",", 1)[0]
+
+
+def last_line(path):
+    """The last line of a file, without reading the rest of it."""
+    # Seeks back from the end a block at a time until it has a whole line;
+    # logs grow without bound.
+    try:
+        with open(path, "rb") as f:
+            end = f.seek(0, 2)
+            pos, tail = end, b""
+            while pos > 0:
+                pos = max(0, pos - 1024)
+                f.seek(pos)
+                tail = f.read(end - pos)
+                if tail.rstrip(b"\r\n").find(b"\n") >= 0:
+                    break
+    except OSError:
+        return None
+    lines = tail.decode("utf-8", "replace").strip().splitlines()
+    return lines[-1] if lines else None
+
+
+class LogIndex:
+    def __init__(self, logfile):
+        self.logfile = logfile
+        self.idxfile = logfile.with_suffix(".idx")
+        self.blocks = []
+        self.latest = []  # latest[i] = latest row time in blocks[0..i]
+        self.loaded = False
+        self.lock = threading.Lock()
+
+    @property
+    def end(self):
+        return self.blocks[-1].end if self.blocks else 0
+
+    # --- Index upkeep ---
+
+    def refresh(self):
+        """Indexes whole blocks appended since the last call. Returns the log size."""
+        with self.lock:
+            size = os.path.getsize(self.logfile)
+            if not self.loaded:
+                self._load()
+            if size < self.end:  # truncated or rewritten
+                self._reset()
+            if size - self.end >= BLOCK:
+                self._extend(size)
+            return size
+
+    def truncate(self, size):
+        """Forgets the blocks past size, once the log has been cut back to it."""
+        with self.lock:
+            if not self.loaded:
+                self._load()
+            keep = [b for b in self.blocks if b.end <= size]
+            if len(keep) == len(self.blocks):
+                return
+            self.blocks, self.latest = keep, self.latest[:len(keep)]
+            with open(self.idxfile, "wb") as f:
+                for b in keep:
+                    f.write(b"%d,%d,%s,%s\n" % (b.start, b.end, b.first, b.last))
+
+    def _load(self):
+        self.loaded = True
+        try:
+            with open(self.idxfile, "rb") as f:
+                for line in f:
+                    start, end, first, last = line.rstrip(b"\n").split(b",")
+                    if int(start) != self.end:
+                        raise ValueError("gap in index")
+                    self._add(Block(int(start), int(end), first, last))
+        except FileNotFoundError:
+            pass
+        except ValueError:
+            self._reset()
+
+    def _reset(self):
+        self.blocks, self.latest = [], []
+        try:
+            os.remove(self.idxfile)
+        except FileNotFoundError:
+            pass
+
+    def _add(self, block):
+        self.blocks.append(block)
+        self.latest.append(max(block.last, self.latest[-1]) if self.latest else block.last)
+
+    def _extend(self, size):
+        added = []
+        with open(self.logfile, "rb") as f:
+            f.seek(self.end)
+            start = pos = self.end
+            first = last = None
+            for line in f:
+                if pos + len(line) > size or not line.endswith(b"\n"):
+                    break  # a row still being written
+                pos += len(line)
+                t = row_time(line)
+                first = t if first is None or t < first else first
+                last = t if last is None or t > last else last
+                if pos - start >= BLOCK:
+                    added.append(Block(start, pos, first, last))
+                    start, first, last = pos, None, None
+        with open(self.idxfile, "ab") as f:
+            for b in added:
+                self._add(b)
+                f.write(b"%d,%d,%s,%s\n" % (b.start, b.end, b.first, b.last))
+
+    # --- Queries ---
+
+    def rows(self, lo=None, hi=None, limit=None):
+        """Rows with lo <= time <= hi (bytes, either may be None), as lines.
+
+        Without a limit the rows stream out in log order. With one, only
+        the newest `limit` rows are returned, in time order; blocks are read
+        from the end and the walk stops once no earlier block can hold a
+        newer row.
+        """
+        size = self.refresh()
+        tail = Block(self.end, size, None, None)
+        if limit == 0:
+            return []
+        if limit is None:
+            return self._stream(lo, hi, tail)
+        return self._newest(lo, hi, limit, tail)
+
+    def _read(self, f, block, lo, hi):
+        f.seek(block.start)
+        data = f.read(block.end - block.start)
+        for line in data.splitlines(keepends=True):
+            if not line.endswith(b"\n"):
+                break
+            t = row_time(line)
+            if (lo is None or t >= lo) and (hi is None or t <= hi):
+                yield t, line
+
+    def _stream(self, lo, hi, tail):
+        blocks = [b for b in self.blocks if b.overlaps(lo, hi)]
+        with open(self.logfile, "rb") as f:
+            for block in blocks + [tail]:
+                for _, line in self._read(f, block, lo, hi):
+                    yield line
+
+    def _newest(self, lo, hi, limit, tail):
+        found = []
+        with open(self.logfile, "rb") as f:
+            found.extend(self._read(f, tail, lo, hi))
+            for i in range(len(self.blocks) - 1, -1, -1):
+                if len(found) >= limit:
+                    found.sort(key=lambda item: item[0])
+                    del found[:-limit]
+                    if self.latest[i] < found[0][0]:
+                        break
+                if self.blocks[i].overlaps(lo, hi):
+                    found.extend(self._read(f, self.blocks[i], lo, hi))
+        found.sort(key=lambda item: item[0])
+        return [line for _, line in found[-limit:]]
@@ -0,0 +1,436 @@
+"""Sensor logs partitioned by day, with closed days compressed.
+
+    logs/<sensor>/YYYY-MM-DD.csv     rows being written (today, backlog)
+    logs/<sensor>/YYYY-MM-DD.csv.z   a closed day, compressed
+
+A row goes to the partition of the day in its own timestamp, so a day's
+rows are always in that day's files, and a range query only opens the
+days it covers. Once a day has ended and its .csv has not been written
+for CLOSE_AFTER seconds, the compactor thread sorts it (together with
+any .csv.z the day already had) and writes it as:
+
+    frame*   independent zlib streams of whole rows, FRAME bytes raw each
+    index    one line per frame: offset,length,raw_length,first_time,last_time
+    footer   index_length:u32le b"FRZ2"
+
+so a reader seeks to the footer, then decompresses only the frames that
+overlap its range. Backlog rows for a closed day land in a fresh .csv
+next to the .csv.z and are folded in the next time it is compacted.
+Readers see both. (FRZ1 files, from before raw lengths were kept, are
+still read.)
+
+As bytes, a log is every day's .csv.z decompressed and then its .csv, in
+day order (parts()), which is what -log serves. Only the newest part
+grows as rows come in, so a Range request can pick up where an earlier
+download stopped; etag() changes whenever anything else does.
+
+A sensor still on a single flat logs/<sensor>.csv is split into
+partitions the first time it is used; the flat file is kept as
+<sensor>.csv.migrated.
+
+    python3 logstore.py migrate LOGDIR   # split every flat log now
+    python3 logstore.py compact LOGDIR   # compress every closed day now
+"""
+
+import os
+import re
+import struct
+import sys
+import threading
+import time
+import zlib
+from pathlib import Path
+
+from logindex import row_time
+
+FRAME = 64 * 1024
+CLOSE_AFTER = 3600  # seconds
+COMPACT_EVERY = 600  # seconds between compactor passes
+LEVEL = 6
+
+FOOTER = struct.Struct("<I4s")
+MAGIC = b"FRZ2"
+OLD_MAGIC = b"FRZ1"  # no raw_length in the index
+DAY = re.compile(r"\d{4}-\d{2}-\d{2}$")
+
+
+def today():
+    return time.strftime("%Y-%m-%d")
+
+
+# --- Compressed days ---
+
+def write_frames(path, lines):
+    """Writes sorted lines as a framed .csv.z, through a temporary file."""
+    tmp = path.with_name(path.name + ".tmp")
+    index = []
+    with open(tmp, "wb") as f:
+        chunk, size = [], 0
+        for line in lines + [None]:
+            if line is not None:
+                chunk.append(line)
+                size += len(line)
+            if chunk and (line is None or size >= FRAME):
+                data = zlib.compress(b"".join(chunk), LEVEL)
+                index.append(b"%d,%d,%d,%s,%s\n" % (f.tell(), len(data), size, row_time(chunk[0]), row_time(chunk[-1])))
+                f.write(data)
+                chunk, size = [], 0
+        index = b"".join(index)
+        f.write(index)
+        f.write(FOOTER.pack(len(index), MAGIC))
+    os.replace(tmp, path)
+
+
+def read_index(f):
+    """(offset, length, raw_length, first, last) of every frame."""
+    f.seek(-FOOTER.size, 2)
+    length, magic = FOOTER.unpack(f.read(FOOTER.size))
+    if magic not in (MAGIC, OLD_MAGIC):
+        raise ValueError(f"{f.name}: not a frame file")
+    f.seek(-FOOTER.size - length, 2)
+    frames = []
+    for line in f.read(length).splitlines():
+        fields = line.split(b",")
+        if magic == OLD_MAGIC:
+            fields.insert(2, b"-1")
+        offset, size, raw, first, last = fields
+        frames.append((int(offset), int(size), int(raw), first, last))
+    if magic == OLD_MAGIC:
+        for i, (offset, size, _, first, last) in enumerate(frames):
+            f.seek(offset)
+            frames[i] = (offset, size, len(zlib.decompress(f.read(size))), first, last)
+    return frames
+
+
+def read_frames(f, lo=None, hi=None):
+    """Lines of a .csv.z, decompressing only frames that overlap lo..hi."""
+    for offset, size, _, first, last in read_index(f):
+        if (lo is not None and last < lo) or (hi is not None and first > hi):
+            continue
+        f.seek(offset)
+        yield from zlib.decompress(f.read(size)).splitlines(keepends=True)
+
+
+def whole_length(path):
+    """Bytes of a .csv up to the end of its last whole row."""
+    with open(path, "rb") as f:
+        end = f.seek(0, 2)
+        pos = end
+        while pos > 0:
+            step = min(pos, 1024)
+            f.seek(pos - step)
+            cut = f.read(step).rfind(b"\n")
+            if cut >= 0:
+                return pos - step + cut + 1
+            pos -= step
+    return 0
+
+
+# --- One sensor ---
+
+class PartitionedLog:
+    def __init__(self, directory):
+        self.dir = directory
+        self.lock = threading.Lock()  # writes, and the caches below; the compactor shares them
+        self._days = []  # sorted names of days with a .csv or .csv.z
+        self._dir_mtime = None
+        self._packed_lengths = {}  # day -> decompressed length of its .csv.z
+
+    def exists(self):
+        return self.dir.is_dir()
+
+    def days(self):
+        # Re-listed only when a partition was added or removed; appends do
+        # not touch the directory's mtime.
+        try:
+            mtime = self.dir.stat().st_mtime_ns
+        except FileNotFoundError:
+            return []
+        with self.lock:
+            if mtime != self._dir_mtime:
+                names = {n.split(".", 1)[0] for n in os.listdir(self.dir)}
+                self._days = sorted(n for n in names if DAY.match(n))
+                self._dir_mtime = mtime
+                self._packed_lengths = {}  # compaction replaces files, which lists again
+            return self._days
+
+    def plain(self, day):
+        return self.dir / f"{day}.csv"
+
+    def packed(self, day):
+        return self.dir / f"{day}.csv.z"
+
+    # --- Writing ---
+
+    def append(self, lines):
+        """lines: whole CSV rows (str), each starting with its timestamp."""
+        by_day = {}
+        for line in lines:
+            by_day.setdefault(line[:10], []).append(line)
+        with self.lock:
+            self.dir.mkdir(parents=True, exist_ok=True)
+            for day, day_lines in by_day.items():
+                with open(self.plain(day), "a") as f:
+                    f.writelines(day_lines)
+
+    def version(self):
+        """Changes whenever the newest row might have."""
+        days = self.days()
+        if not days:
+            return None
+        try:
+            st = self.plain(days[-1]).stat()
+            newest = (st.st_size, st.st_mtime_ns)
+        except FileNotFoundError:
+            newest = None
+        return self._dir_mtime, newest
+
+    def compact(self, force=False):
+        """Compresses every day that has ended and gone quiet. Returns how many."""
+        done = 0
+        now = time.time()
+        for day in self.days():
+            if day >= today():
+                break
+            plain = self.plain(day)
+            try:
+                mtime = plain.stat().st_mtime
+            except FileNotFoundError:
+                continue  # already compressed
+            if not force and now - mtime < CLOSE_AFTER:
+                continue
+            with self.lock:
+                lines = []
+                if self.packed(day).exists():
+                    with open(self.packed(day), "rb") as f:
+                        lines.extend(read_frames(f))
+                with open(plain, "rb") as f:
+                    lines.extend(line if line.endswith(b"\n") else line + b"\n" for line in f)
+                lines.sort(key=row_time)
+                write_frames(self.packed(day), lines)
+                os.remove(plain)
+                self._packed_lengths.pop(day, None)
+            done += 1
+        return done
+
+    # --- Reading ---
+
+    def _open(self, day):
+        # Both files of a day are opened under the lock, so a compaction
+        # in between cannot make a reader miss or repeat rows.
+        with self.lock:
+            files = []
+            for path in (self.packed(day), self.plain(day)):
+                try:
+                    files.append(open(path, "rb"))
+                except FileNotFoundError:
+                    pass
+            return files
+
+    def _day_rows(self, day, lo, hi):
+        for f in self._open(day):
+            with f:
+                lines = read_frames(f, lo, hi) if f.name.endswith(".z") else f
+                for line in lines:
+                    if not line.endswith(b"\n"):
+                        break  # a row still being written
+                    t = row_time(line)
+                    if (lo is None or t >= lo) and (hi is None or t <= hi):
+                        yield t, line
+
+    def _days_in(self, lo, hi):
+        return [d for d in self.days()
+                if (lo is None or d >= lo[:10].decode()) and (hi is None or d <= hi[:10].decode())]
+
+    def rows(self, lo=None, hi=None, limit=None):
+        """Rows with lo <= time <= hi (bytes, either may be None), as lines.
+
+        Only the days in the range are opened. Without a limit the rows
+        stream out day by day; with one, the newest `limit` rows are
+        returned in time order, reading days from the newest back until
+        enough are found.
+        """
+        days = self._days_in(lo, hi)
+        if limit is None:
+            return (line for day in days for _, line in self._day_rows(day, lo, hi))
+        found = []
+        for day in reversed(days):
+            if len(found) >= limit:
+                break
+            day_rows = sorted(self._day_rows(day, lo, hi), key=lambda item: item[0])
+            found[:0] = day_rows
+        return [line for _, line in found[-limit:]] if limit else []
+
+    def last_line(self):
+        """The newest row by time. The end of the newest file can be a
+        node's spooled backlog, so the newest day is read whole."""
+        lines = self.rows(limit=1)
+        return lines[0].decode("utf-8", "replace").rstrip("\n") if lines else None
+
+    # --- As bytes ---
+
+    def parts(self):
+        """(path, length) of every file -log serves, in order; a .csv.z by
+        its decompressed length, a .csv up to its last whole row."""
+        parts = []
+        for day in self.days():
+            try:
+                with self.lock:
+                    length = self._packed_lengths.get(day)
+                if length is None:
+                    with open(self.packed(day), "rb") as f:
+                        length = sum(frame[2] for frame in read_index(f))
+                    with self.lock:
+                        self._packed_lengths[day] = length
+                parts.append((self.packed(day), length))
+            except FileNotFoundError:
+                pass
+            try:
+                parts.append((self.plain(day), whole_length(self.plain(day))))
+            except FileNotFoundError:
+                pass
+        return [(path, length) for path, length in parts if length]
+
+    def etag(self, parts):
+        # Everything but the newest part's length: rows appended to it do
+        # not change the bytes a client already has.
+        if not parts:
+            return "empty"
+        key = ";".join(f"{path.name}:{length}" for path, length in parts[:-1]) + ";" + parts[-1][0].name
+        return "%08x-%x" % (zlib.crc32(key.encode()), len(parts))
+
+    def read(self, parts, start=0, stop=None):
+        """Bytes start..stop of parts(), in chunks."""
+        # A part compacted away since parts() raises FileNotFoundError; the
+        # response is cut short and the client asks again.
+        pos = 0
+        for path, length in parts:
+            lo, hi = max(start - pos, 0), length if stop is None else min(stop - pos, length)
+            pos += length
+            if lo >= hi:
+                continue
+            with open(path, "rb") as f:
+                if path.suffix == ".z":
+                    raw = 0
+                    for offset, size, raw_length, _, _ in read_index(f):
+                        if raw < hi and raw + raw_length > lo:
+                            f.seek(offset)
+                            yield zlib.decompress(f.read(size))[max(lo - raw, 0):hi - raw]
+                        raw += raw_length
+                else:
+                    f.seek(lo)
+                    while lo < hi:
+                        chunk = f.read(min(FRAME, hi - lo))
+                        if not chunk:
+                            break
+                        lo += len(chunk)
+                        yield chunk
+
+    # --- Migration ---
+
+    def migrate(self, flat):
+        """Splits a flat <sensor>.csv into day partitions and compresses the closed ones."""
+        buffers, skipped = {}, 0
+
+        def spill(day):
+            with open(self.plain(day), "a") as out:
+                out.writelines(buffers.pop(day))
+
+        self.dir.mkdir(parents=True, exist_ok=True)
+        with open(flat) as f:
+            for line in f:
+                day = line[:10]
+                if not DAY.match(day):
+                    skipped += 1
+                    continue
+                if not line.endswith("\n"):
+                    line += "\n"
+                buffers.setdefault(day, []).append(line)
+                if len(buffers[day]) >= 10000:
+                    spill(day)
+        for day in list(buffers):
+            spill(day)
+        flat.rename(flat.with_name(flat.name + ".migrated"))
+        try:
+            os.remove(flat.with_suffix(".idx"))
+        except FileNotFoundError:
+            pass
+        self.compact(force=True)
+        return skipped
+
+
+# --- Every sensor ---
+
+class LogStore:
+    def __init__(self, root):
+        self.root = Path(root)
+        self.logs = {}
+        self.lock = threading.Lock()
+        self._compactor = None
+
+    def get(self, sensor):
+        """The sensor's log, or None if it has none yet."""
+        # Only logs on disk are kept, so asking for made-up names costs nothing
+        with self.lock:
+            log = self.logs.get(sensor) or self._load(sensor)
+            if not log.exists():
+                return None
+            self.logs[sensor] = log
+        return log
+
+    def create(self, sensor):
+        """The sensor's log, to be written to; its directory is made on the first append."""
+        with self.lock:
+            log = self.logs.get(sensor) or self._load(sensor)
+            self.logs[sensor] = log
+        self._start_compactor()
+        return log
+
+    def _load(self, sensor):
+        log = PartitionedLog(self.root / sensor)
+        flat = self.root / f"{sensor}.csv"
+        if flat.exists():
+            skipped = log.migrate(flat)
+            print(f"[logstore] {sensor}: split into {len(log.days())} days"
+                  + (f", {skipped} unreadable rows left in {flat.name}.migrated" if skipped else ""))
+        return log
+
+    def sensors(self):
+        names = {p.name for p in self.root.iterdir() if p.is_dir() and p.name != "rollups"}
+        names |= {p.stem for p in self.root.glob("*.csv")}
+        return sorted(names)
+
+    def compact(self, force=False):
+        for sensor in self.sensors():
+            log = self.get(sensor)
+            if log:
+                log.compact(force)
+
+    def _start_compactor(self):
+        # Started on first write, like the alert worker, so it runs in the
+        # process that serves requests.
+        if self._compactor is None:
+            with self.lock:
+                if self._compactor is None:
+                    self._compactor = threading.Thread(target=self._compact_loop, name="compactor", daemon=True)
+                    self._compactor.start()
+
+    def _compact_loop(self):
+        while True:
+            try:
+                self.compact()
+            except Exception as e:
+                print(f"[logstore] compaction failed: {e}")
+            time.sleep(COMPACT_EVERY)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3 or sys.argv[1] not in ("migrate", "compact"):
+        sys.exit("usage: logstore.py migrate|compact LOGDIR")
+    store = LogStore(sys.argv[2])
+    for sensor in store.sensors():
+        start = time.perf_counter()
+        log = store.get(sensor)
+        if log and sys.argv[1] == "compact":
+            log.compact(force=True)
+        print(f"{sensor}: {time.perf_counter() - start:.1f} s")
@@ -0,0 +1,379 @@
+"""Per-minute, per-hour and per-day rollups of each sensor's log.
+
+Graphs over weeks or months do not need every 10-second row. For each
+sensor and tier, logs/rollups/<sensor>.<tier>.csv has one row per bucket:
+
+    bucket_start,temp_n,temp_min,temp_max,temp_mean,humidity_n,...
+
+(count, min, max and mean for every log field; a channel with no values
+in the bucket is "0,,,"). Buckets are local time, cut the same way the
+log's timestamps are written, so they line up with the raw rows.
+
+Ingest calls add() with the rows it just logged. The bucket still filling
+up is kept in memory and is written once a row for a later bucket
+arrives, so each tier file is appended in order and can be read through a
+LogIndex. A row for a bucket that was already written
+(a node's spooled backlog) goes to <sensor>.<tier>.late.csv instead and
+is merged in when read. After a restart the open buckets are rebuilt from
+the raw log, from the last bucket each tier has written; a sensor without
+rollups yet gets them built from its whole log. The log is read a day at
+a time, each day sorted, so each bucket is written as soon as the rows
+move past it and a build of years of log holds only the newest bucket per
+tier. app.py does
+this for every sensor at startup, not on the first request.
+
+Late rows are folded back in at startup, and whenever a late file passes
+LATE_FOLD bytes: the tier file is cut back to the first late bucket and
+everything from there is counted again from the raw log, which already
+holds the late rows. The late file is then removed.
+
+query() picks the coarsest tier that still gives at least `points`
+buckets over the range, and falls back to the raw rows when even minutes
+are too coarse. Neighbouring buckets are then merged until there are
+about `points`, so a response never holds much more than the chart can
+draw.
+
+    python3 rollup.py LOGDIR    # rebuild every sensor's rollups from its log
+"""
+
+import os
+import sys
+import threading
+import time
+from itertools import groupby
+from pathlib import Path
+
+from logindex import LogIndex, last_line, row_time
+from logstore import LogStore
+
+# name, seconds, characters of "YYYY-MM-DD HH:MM:SS" kept, what fills the rest
+TIERS = (
+    ("1m", 60, 16, ":00"),
+    ("1h", 3600, 13, ":00:00"),
+    ("1d", 86400, 10, " 00:00:00"),
+)
+RAW_STEP = 10  # seconds between a node's reports
+LATE_FOLD = 64 * 1024  # bytes of late rows before they are folded in
+WRITE_ROWS = 4096  # buckets closed while recovering before they are written
+TIME_FORMAT = "%Y-%m-%d %H:%M:%S"
+
+
+# --- Buckets ---
+# A bucket is a list with one entry per field: None, or [count, min, max, mean].
+
+def add_value(aggs, i, v):
+    a = aggs[i]
+    if a is None:
+        aggs[i] = [1, v, v, v]
+        return
+    a[0] += 1
+    a[1] = min(a[1], v)
+    a[2] = max(a[2], v)
+    a[3] += (v - a[3]) / a[0]
+
+
+def merge(dst, src):
+    for i, b in enumerate(src):
+        if b is None:
+            continue
+        a = dst[i]
+        if a is None:
+            dst[i] = list(b)
+            continue
+        n = a[0] + b[0]
+        a[1], a[2], a[3] = min(a[1], b[1]), max(a[2], b[2]), (a[3] * a[0] + b[3] * b[0]) / n
+        a[0] = n
+
+
+def parse_value(text):
+    try:
+        v = float(text)
+    except ValueError:
+        return None
+    return v if v == v else None  # NaN
+
+
+def format_row(key, aggs):
+    parts = [key]
+    for a in aggs:
+        parts.append("%d,%g,%g,%.3f" % tuple(a) if a else "0,,,")
+    return ",".join(parts) + "\n"
+
+
+def parse_row(line, nfields):
+    parts = line.rstrip("\n").split(",")
+    aggs = []
+    for i in range(nfields):
+        n, lo, hi, mean = parts[1 + 4 * i:5 + 4 * i]
+        aggs.append([int(n), float(lo), float(hi), float(mean)] if n != "0" else None)
+    return parts[0], aggs
+
+
+class Tier:
+    def __init__(self, directory, sensor, name, step, cut, pad):
+        self.name, self.step, self.cut, self.pad = name, step, cut, pad
+        self.main = directory / f"{sensor}.{name}.csv"
+        self.late = directory / f"{sensor}.{name}.late.csv"
+        self.main.touch()
+        self.index = LogIndex(self.main)
+        self.open = {}  # bucket -> aggs, not written yet
+        line = last_line(self.main)
+        self.written = line.split(",", 1)[0] if line else ""  # last bucket in main
+
+    def bucket(self, t):
+        return t[:self.cut] + self.pad
+
+    def late_keys(self):
+        try:
+            with open(self.late) as f:
+                return [line.split(",", 1)[0] for line in f if line.strip()]
+        except FileNotFoundError:
+            return []
+
+    def cut_at(self, key):
+        """Drops the written buckets from key on, and the late file."""
+        key = key.encode()
+        self.index.refresh()
+        start = next((b.start for b in self.index.blocks if b.last >= key), self.index.end)
+        with open(self.main, "rb+") as f:
+            f.seek(start)
+            pos = start
+            for line in f:
+                if row_time(line) >= key:
+                    break
+                pos += len(line)
+            f.truncate(pos)
+        self.index.truncate(pos)
+        # A crash from here on leaves late rows past `written`; the next
+        # fold drops them, as the raw log covers those buckets again.
+        line = last_line(self.main)
+        self.written = line.split(",", 1)[0] if line else ""
+        os.remove(self.late)
+
+
+class SensorRollups:
+    def __init__(self, directory, sensor, fields, raw):
+        self.fields = fields
+        self.raw = raw
+        self.tiers = [Tier(directory, sensor, *tier) for tier in TIERS]
+        self.lock = threading.Lock()
+        self._fold_late()
+        self._recover()
+
+    def _fold_late(self):
+        # The late rows are in the raw log too, so the tiers are cut back
+        # to their first late bucket and _recover() counts from there.
+        if self.raw is None:
+            return False
+        folded = False
+        for tier in self.tiers:
+            keys = tier.late_keys()
+            if keys:
+                tier.cut_at(min(keys))
+                folded = True
+            elif tier.late.exists():
+                os.remove(tier.late)
+        if folded:
+            for tier in self.tiers:
+                tier.open = {}
+        return folded
+
+    def _recover(self):
+        if self.raw is None:
+            return
+        lo = min(tier.written for tier in self.tiers)
+        # Backlog leaves a day's rows out of order; the days themselves come in order
+        days = groupby(self.raw.rows(lo.encode() if lo else None), key=lambda line: line[:10])
+        rows = (self._raw_row(line) for _, day in days for line in sorted(day, key=row_time))
+        self._collect(rows, late=None)
+        self._flush({})
+
+    def _raw_row(self, line):
+        parts = line.decode("utf-8", "replace").rstrip("\n").split(",")
+        return parts[0], parts[2:2 + len(self.fields)]
+
+    def add(self, rows):
+        """rows: (time, values) as just logged, values as written to the log."""
+        with self.lock:
+            late = {}
+            self._collect(rows, late)
+            self._flush(late)
+            if late and any(tier.late.stat().st_size >= LATE_FOLD for tier in late) and self._fold_late():
+                self._recover()
+
+    def _collect(self, rows, late):
+        # late is None while recovering: rows in written buckets are already
+        # counted there, and the rows come in time order, so a row for a new
+        # bucket closes the one before.
+        nfields = len(self.fields)
+        closed = {tier: [] for tier in self.tiers}
+        for t, values in rows:
+            parsed = [(i, parse_value(v)) for i, v in enumerate(values[:nfields]) if v not in ("", None)]
+            for tier in self.tiers:
+                key = tier.bucket(t)
+                if key > tier.written:
+                    target = tier.open
+                    if late is None and target and key not in target:
+                        closed[tier].extend(target.items())
+                        target.clear()
+                        if len(closed[tier]) >= WRITE_ROWS:
+                            self._write(tier, closed[tier])
+                elif late is not None:
+                    target = late.setdefault(tier, {})
+                else:
+                    continue
+                aggs = target.get(key)
+                if aggs is None:
+                    aggs = target[key] = [None] * nfields
+                for i, v in parsed:
+                    if v is not None:
+                        add_value(aggs, i, v)
+        for tier, done in closed.items():
+            if done:
+                self._write(tier, done)
+
+    def _write(self, tier, done):
+        # done: (bucket, aggs) in order, all after tier.written; emptied
+        with open(tier.main, "a") as f:
+            f.writelines(format_row(key, aggs) for key, aggs in done)
+        tier.written = done[-1][0]
+        done.clear()
+
+    def _flush(self, late):
+        for tier in self.tiers:
+            keys = sorted(tier.open)[:-1]  # everything but the newest bucket
+            if keys:
+                self._write(tier, [(key, tier.open.pop(key)) for key in keys])
+            if late.get(tier):
+                with open(tier.late, "a") as f:
+                    f.writelines(format_row(key, aggs) for key, aggs in sorted(late[tier].items()))
+
+    # --- Queries ---
+
+    def query(self, lo, hi, points):
+        """Buckets from lo to hi (epoch seconds), as columns for a chart."""
+        lo_t = time.strftime(TIME_FORMAT, time.localtime(lo))
+        hi_t = time.strftime(TIME_FORMAT, time.localtime(hi))
+        tier = next((t for t in reversed(self.tiers) if (hi - lo) / t.step >= points), None)
+        with self.lock:
+            if tier is None:
+                name, step, buckets = "raw", RAW_STEP, self._raw_buckets(lo_t, hi_t)
+            else:
+                name, step, buckets = tier.name, tier.step, self._tier_buckets(tier, lo_t, hi_t)
+        # The next tier up can be far too coarse (a week is 168 hours but
+        # 10080 minutes); merge neighbours until there are about `points`.
+        group = len(buckets) // points
+        if group > 1:
+            step *= group
+            merged = []
+            for i in range(0, len(buckets), group):
+                key, aggs = buckets[i]
+                for _, more in buckets[i + 1:i + group]:
+                    merge(aggs, more)
+                merged.append((key, aggs))
+            buckets = merged
+
+        out = {"tier": name, "step": step, "time": [key for key, _ in buckets]}
+        for i, field in enumerate(self.fields):
+            column = [aggs[i] for _, aggs in buckets]
+            out[field] = {
+                "count": [a[0] if a else 0 for a in column],
+                "min": [a[1] if a else None for a in column],
+                "max": [a[2] if a else None for a in column],
+                "mean": [round(a[3], 3) if a else None for a in column],
+            }
+        return out
+
+    def _tier_buckets(self, tier, lo_t, hi_t):
+        lo_key = tier.bucket(lo_t)
+        nfields = len(self.fields)
+        buckets = {}
+
+        def take(key, aggs):
+            if key in buckets:
+                merge(buckets[key], aggs)
+            else:
+                buckets[key] = [list(a) if a else None for a in aggs]
+
+        for line in tier.index.rows(lo_key.encode(), hi_t.encode()):
+            take(*parse_row(line.decode(), nfields))
+        try:
+            with open(tier.late) as f:
+                for line in f:
+                    key, aggs = parse_row(line, nfields)
+                    if lo_key <= key <= hi_t:
+                        take(key, aggs)
+        except FileNotFoundError:
+            pass
+        for key, aggs in tier.open.items():
+            if lo_key <= key <= hi_t:
+                take(key, aggs)
+        return sorted(buckets.items())
+
+    def _raw_buckets(self, lo_t, hi_t):
+        if self.raw is None:
+            return []
+        buckets = []
+        for line in self.raw.rows(lo_t.encode(), hi_t.encode()):
+            t, values = self._raw_row(line)
+            aggs = [None] * len(self.fields)
+            for i, v in enumerate(values):
+                v = parse_value(v)
+                if v is not None:
+                    add_value(aggs, i, v)
+            buckets.append((t, aggs))
+        buckets.sort(key=lambda item: item[0])
+        return buckets
+
+
+class Rollups:
+    """Every sensor's rollups. raw_log(sensor) gives its log (logstore.py), or None."""
+
+    def __init__(self, directory, fields, raw_log):
+        self.directory = Path(directory)
+        self.directory.mkdir(parents=True, exist_ok=True)
+        self.fields = fields
+        self.raw_log = raw_log
+        self.sensors = {}
+        self.lock = threading.Lock()
+
+    def get(self, sensor):
+        with self.lock:
+            return self._get(sensor)
+
+    def _get(self, sensor):
+        rollups = self.sensors.get(sensor)
+        if rollups is None:
+            rollups = self.sensors[sensor] = SensorRollups(
+                self.directory, sensor, self.fields, self.raw_log(sensor))
+        return rollups
+
+    def add(self, sensor, rows):
+        with self.lock:
+            fresh = sensor not in self.sensors
+            rollups = self._get(sensor)
+        # A sensor's first rollups are built from its log, which already
+        # holds these rows
+        if not fresh or rollups.raw is None:
+            rollups.add(rows)
+
+    def query(self, sensor, lo, hi, points):
+        return self.get(sensor).query(lo, hi, points)
+
+
+def rebuild(logdir, fields):
+    store = LogStore(logdir)
+    directory = Path(logdir) / "rollups"
+    directory.mkdir(exist_ok=True)
+    for sensor in store.sensors():
+        for path in directory.glob(f"{sensor}.*"):
+            os.remove(path)
+        start = time.perf_counter()
+        SensorRollups(directory, sensor, fields, store.get(sensor))
+        print(f"{sensor}: {time.perf_counter() - start:.1f} s")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip().splitlines()[-1].strip())
+    rebuild(sys.argv[1], ("temp", "humidity", "lux", "tds"))  # app.py's log_fields